@@ -11,32 +11,89 @@ Output should have 538 unique 5-cliques sans anagrams.  The following list DOES
 
 See:
 * https://en.wikipedia.org/wiki/Clique_(graph_theory)
+
+Usage:
+    5letters5words [threads] [dictionary] [-engine=name] [-simd=scalar|avx2|avx512] [-prune] [-order=name] [-count] [-anagrams] [-cache[=file]] [-shape=WxC] [-alphabet=letters|@file] [-cover=lengths]
+
+    threads     0 = auto-detect, use max threads
+    dictionary  default is words_alpha.txt, - reads from stdin
+                More than 8,192 unique 5 letter words are searched as -shape=5x5.  Can't be combined with -anagrams
+    -engine     search engine to use, default is dag.  -help lists all engines
+    -simd       limit the SIMD kernels to scalar, avx2, or avx512.  Default is the best the CPU supports
+    -prune      remove words that can't be in a clique (4-core) before searching
+    -order      renumber the words before building the DAG, default is file order.  -help lists all orders
+    -count      only count the cliques, in total and per missing letter.  Without -anagrams the last level is counted, not walked
+    -anagrams   also output every combination of anagrams of each clique
+    -cache      load the words and DAG from a binary cache of the dictionary, default file is <dictionary>.cache.
+                The cache is rebuilt when the dictionary changes.  Only the file order skips Prepare()
+                The DAG is only saved when -prune or the engine reads it in file order; bitset, rare, zeta, split,
+                and any -order without -prune only cache the words.  A damaged cache is ignored
+    -shape      solve a different puzzle, W words of C letters: 6x4, 5x5, 4x6, 3x8.  Ignores -engine, -order, -prune, -cache
+                Can't be combined with -anagrams or -cover
+    -alphabet   letters of -shape puzzles as UTF-8, up to 128, default a-z.  Implies -shape=5x5
+                @file reads them from a UTF-8 file instead, since the Windows command line is ANSI
+    -cover      exact cover with words of mixed lengths, e.g. 4+5+5+5+6.  Lengths up to 26 letters cover the whole alphabet
+                Ignores -engine, -order, -prune, -cache.  Can't be combined with -anagrams, -shape or -alphabet
 */
 
 // Includes
     #define _CRT_SECURE_NO_WARNINGS 1 // MSVC warnings
-    #include <stdio.h>    // printf(), fopen(), fread(), fclose()
+    #include <stdio.h>    // printf(), fopen(), fread(), fclose(), rename()
     #include <stdlib.h>   // atoi(), exit()
     #include <sys/stat.h> // stat()
     #include <string.h>   // memset()
+    #include <stdint.h>   // uint64_t
+    #include <algorithm>  // sort(), stable_sort(), reverse()
+    #include <atomic>     // memo table
     #include <chrono>     // now()
+    #include <thread>     // yield()
     #include <omp.h>
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>  // CreateFileMapping(), MapViewOfFile()
+    #include <io.h>       // _setmode()
+    #include <fcntl.h>    // _O_BINARY
+#else
+    #include <sys/mman.h> // mmap()
+    #include <fcntl.h>    // open()
+    #include <unistd.h>   // close()
+#endif
 #ifdef _MSC_VER 
     #include <intrin.h>                 // https://stackoverflow.com/questions/3849337/msvc-equivalent-to-builtin-popcount
     #define __builtin_popcount __popcnt // same as gcc; also known as Hamming Weight, https://en.wikipedia.org/wiki/Hamming_weight
+    inline int __builtin_ctz  ( unsigned int       x ) { unsigned long i; _BitScanForward  ( &i, x ); return (int) i; } // count trailing zeroes
+  #if defined(_M_X64)
+    #define __builtin_popcountll __popcnt64
+    inline int __builtin_ctzll( unsigned long long x ) { unsigned long i; _BitScanForward64( &i, x ); return (int) i; }
+  #else                                 // Win32 has no 64-bit intrinsics, use both halves
+    inline int __builtin_popcountll( unsigned long long x ) { return (int)(__popcnt( (unsigned int) x ) + __popcnt( (unsigned int)(x >> 32) )); }
+    inline int __builtin_ctzll( unsigned long long x )
+    {
+        unsigned long i;
+        if (_BitScanForward( &i, (unsigned long) x ))
+            return (int) i;
+        _BitScanForward( &i, (unsigned long)(x >> 32) );
+        return (int) i + 32;
+    }
+  #endif
 #endif
 
-#if _WIN32                // MS-DOS / Windows
-    #define EOL_CHAR '\r' // 0x0D 0x0A
-    #define EOL_SIZE 2    // CR LF
-#else                     // Un*x
-    #define EOL_CHAR '\n' // 0x0A
-    #define EOL_SIZE 1    // LF
+#if defined(__x86_64__) || defined(_M_X64)
+    #define USE_SIMD 1
+    #include <immintrin.h> // AVX2, AVX-512
+  #ifdef _MSC_VER             // MSVC doesn't need /arch to emit intrinsics
+    #define TARGET_AVX2
+    #define TARGET_AVX512
+  #else                       // gcc, clang: only these functions are compiled for the wider ISA, see Init() for runtime dispatch
+    #define TARGET_AVX2   __attribute__((target("avx2")))
+    #define TARGET_AVX512 __attribute__((target("avx512f")))
+  #endif
 #endif
 
 // Globals
           size_t gnBufferSize = 0;
-          char   gaBufferText[8388608]; // "all_words.txt" is  4,234,917 bytes
+    const char  *gpBufferText = NULL; // Read-only, either memory mapped or read from a stream. "all_words.txt" is  4,234,917 bytes
 
     // Total number of permutations for one word with 5 letters:
     //   26 * 26 * 26 * 26 * 26 = 26^5 = 11,881,376  <  ceil( log2 ) = 24
@@ -44,224 +101,3741 @@ See:
     const int    NUM_CHARS     =    5;  // letters per word
     const int    NUM_WORDS     =    5;  // total words
     const int    MAX_5_WORDS   = 8192;  // permutation of all letters in one word; in practice we have 5,977 unique words
-    const int    MAX_NEIGHBORS = 4096;  // List of neighbors for this hash; in practice we have 2,347 neighbors.
+    const int    MAX_NEIGHBORS = 4096;  // List of neighbors for this hash; in practice we have 1,839 forward neighbors.
     const int    MAX_THREADS  =   256;  // Threadripper 3990X
+    const int    NUM_LETTERS   =   26;  // a-z
+    const int    ALL_LETTERS   = (1 << NUM_LETTERS) - 1;
+    const int    MASK_SLOTS    = 2*MAX_5_WORDS;         // power of 2, the hash table of unique masks is at most half full
+    const int    MASK_SHIFT    = 32 - 14;               // 32 - log2( MASK_SLOTS )
 
           int    gnUniqueWords = 0;                           // number of words with exactly NUM_CHARS letters
-          char  *gaWords    [ MAX_5_WORDS ];                  // pointers to first letter of words that have 5 letters
+    const char  *gaWords    [ MAX_5_WORDS ];                  // pointers to first letter of words that have 5 letters, NOT null terminated
           int    gaHash     [ MAX_5_WORDS ];
-          short  gaNeighbors[ MAX_5_WORDS ][ MAX_NEIGHBORS ]; // DAG of valid neighbors
-          short  gaSolutions[ MAX_THREADS ];
-          short  gaOutput   [ MAX_THREADS ][ MAX_NEIGHBORS ]; // Each thread outputs 5x words, maximum 538*5 = 2690
+          int    gaAnagrams [ MAX_5_WORDS ];                  // number of words with this mask, i.e. 1 + the anagrams that were skipped
+          int    gaAnagramHead[ MAX_5_WORDS ];                // first of all words with this mask in gpAnagramWords, in file order
+          int    gnAnagramWords = 0;
+    const char **gpAnagramWords = NULL;                       // every word with a known mask, chained by gpAnagramNext
+          int   *gpAnagramNext  = NULL;                       // next word with the same mask, -1 terminates
+          bool   gbAnagrams     = false;                      // Expand each solution into every combination of anagrams
+          int    gaMaskKeys [ MASK_SLOTS  ];                  // open addressing hash table of unique masks: mask, 0 = empty slot
+          short  gaMaskWord [ MASK_SLOTS  ];                  // first word with this mask; only valid during Parse(), words are relabeled later
+          bool   gbPrune     = false;                         // k-core reduction before the search
+          int    gnNeighbors = 0;                             // number of edges in the DAG; 3,213,696 for words_alpha.txt
+          int    gaNeighborStart[ MAX_5_WORDS+1 ];            // CSR offsets: the neighbors of word are gpNeighbors[ gaNeighborStart[word], gaNeighborStart[word+1] )
+          short *gpNeighbors = NULL;                          // CSR edges, DAG of valid neighbors
+          int   *gpNeighborHash = NULL;                       // gaHash[ gpNeighbors[i] ] so filtering streams the masks instead of a dependent load per neighbor
+          bool   gbGraphValid   = false;                      // the CSR graph matches the current word labels, Prepare() has nothing to do
+          bool   gbGraphMapped  = false;                      // gpNeighbors and gpNeighborHash point into the cache file, never free them
+
+    // Graph cache: the parsed words, and the DAG in file order if a run needed it, keyed by the contents of the dictionary
+    const uint32_t CACHE_MAGIC    = 0x57354335;               // "5C5W"
+    const uint32_t CACHE_VERSION  = 2;
+    const int      CACHE_ALIGN    = 64;                       // every section starts on a cache line
+
+    enum CacheSection
+    {
+        CACHE_WORD_OFFSET,                                    // uint32 per unique word, offset into the dictionary text
+        CACHE_HASH,                                           // int    per unique word
+        CACHE_ANAGRAMS,                                       // int    per unique word
+        CACHE_ANAGRAM_HEAD,                                   // int    per unique word
+        CACHE_ANAGRAM_OFFSET,                                 // uint32 per anagram word, offset into the dictionary text
+        CACHE_ANAGRAM_NEXT,                                   // int    per anagram word
+        CACHE_NEIGHBOR_START,                                 // int    per unique word + 1, the graph sections are empty without nGraph
+        CACHE_NEIGHBORS,                                      // short  per neighbor
+        CACHE_NEIGHBOR_HASH,                                  // int    per neighbor
+        NUM_CACHE_SECTIONS
+    };
+
+    struct CacheHeader
+    {
+        uint32_t nMagic;
+        uint32_t nVersion;
+        uint64_t nTextHash;                                   // Checksum() of the dictionary
+        uint64_t nTextSize;
+        uint64_t nWordsCheck;                                 // Checksum() of the sections before CACHE_NEIGHBOR_START
+        uint64_t nGraphCheck;                                 // Checksum() of the graph sections
+        int32_t  nChars;                                      // NUM_CHARS the cache was built for
+        int32_t  nUniqueWords;
+        int32_t  nAnagramWords;
+        int32_t  nNeighbors;
+        int32_t  nMaxNeighbors;
+        int32_t  nGraph;                                      // 1 if the graph sections are present
+        uint64_t aSection[ NUM_CACHE_SECTIONS + 1 ];          // byte offsets from the start of the file, the last one is the file size
+    };
+    const char  *gpCacheName = NULL;                          // -cache: file to load the graph from, or save it to
+          int  (*gpPrepareRow)( int word0, int word1, short *pOut, int *pOutHash ); // Runtime dispatch, see Init()
+          short *gpPrepareRows     = NULL;                    // Per-thread row of the longest row + 16, SIMD stores may write up to 16 entries past the end
+          int   *gpPrepareRowsHash = NULL;                    // only allocated while Prepare() fills in the graph
+          int    gnPrepareRow      = 0;                       // entries per thread
+
+    // Alphabet: each letter is a Unicode code point in the Basic Multilingual Plane, mapped to a bit of the mask.  a-z unless -alphabet
+    const int    MAX_LETTERS   =   128;
+    const int    MAX_CODE      = 0x10000;
+    const unsigned char NO_LETTER = 0xFF;
+
+          int    gnAlphabet = 0;
+    const char  *gaLetterText [ MAX_LETTERS ];                // UTF-8 of each letter, NOT null terminated
+          int    gaLetterBytes[ MAX_LETTERS ];
+    unsigned char gaLetterBit [ MAX_CODE    ];                // code point -> bit, NO_LETTER if it isn't in the alphabet
+
+    // Results
+    const int    CHUNK_SOLUTIONS = 1024;                // solutions per chunk, 10 KB
+
+    struct ResultChunk
+    {
+        ResultChunk *pNext;
+        int          nSolutions;
+        short        aWords[ CHUNK_SOLUTIONS * NUM_WORDS ];
+    };
+
+    struct alignas(64) ResultSink                       // Each thread only writes its own cache line, no false sharing
+    {
+        int          nSolutions;
+        int          nAnagrams;                         // -anagrams: number of solutions including anagrams
+        int          aMissing[ NUM_LETTERS ];           // -count: number of solutions per missing letter
+        int          nFree;                             // solutions left in pTail
+        short       *pWrite;
+        ResultChunk *pHead;
+        ResultChunk *pTail;
+    };
+          ResultSink gaSinks[ MAX_THREADS ];            // Each thread outputs 5x words per solution into a growable list of chunks
+
+    struct alignas(64) WordSink                         // -shape and -cover: any number of words per solution
+    {
+        int          nSolutions;
+        int          nCapacity;
+        int         *pWords;                            // word indices, a fixed number per solution
+        int          aMissing[ MAX_LETTERS ];           // -count: number of solutions by their first missing letter
+    };
+
+          bool       gbCount = false;                   // Only count solutions, never store them
+          bool       gbGroup = false;                   // Output the solutions grouped by missing letter instead of by thread
+          int      (*gpCount)( const int *pHash, int nHash, int nMask ); // Runtime dispatch, see Init()
+
+    enum SimdLevel
+    {
+        SIMD_SCALAR,
+        SIMD_AVX2  ,  //  8 masks per instruction
+        SIMD_AVX512,  // 16 masks per instruction
+        NUM_SIMD
+    };
+    const char  *gaSimdNames[ NUM_SIMD ] = { "scalar", "avx2", "avx512" };
+          int    gnSimd = SIMD_AVX512;                        // Requested maximum, clamped to what the CPU supports
+
+    // Meet in the middle
+          int    gnJoinPairs = 0;
+          int    gnJoinMasks = 0;                             // number of unique 10 letter masks
+          int    gnJoinShift = 0;                             // 32 - log2( gnJoinSlots )
+          int    gnJoinSlots = 0;                             // power of 2, at least 2x gnJoinMasks
+     uint64_t   *gpJoinPairs = NULL;                          // (mask << 32) | (word0 << 16) | word1 sorted by mask then word0
+          int   *gpJoinKeys  = NULL;                          // open addressing hash table: mask, 0 = empty slot
+          int   *gpJoinStart = NULL;                          // [start,end) of this mask's pairs in gpJoinPairs
+          int   *gpJoinEnd   = NULL;
+
+    // Shrinking candidate sets
+          short *gpCandidates = NULL;                         // Per-thread survivors after choosing word1, word2, word3, see ThreadRows()
+          int  (*gpFilter)( const short *pIn, int nIn, int nHash, short *pOut ); // Runtime dispatch, see Init()
+          int  (*gpFilterRow)( const short *pIn, const int *pInHash, int nIn, int nHash, short *pOut ); // Runtime dispatch, see Init()
+    const int    MIN_FILTER_ROW   =  64;                      // shorter rows of the DAG are cheaper to scan than a gpFilterRow call, see ForDisjoint()
+    const int    FILTER_ROW_CHUNK = 256;                      // neighbors per gpFilterRow call, keeps the survivors on the stack small
+#if USE_SIMD
+          unsigned char gaCompress16[ 256 ][ 16 ];            // AVX2 has no compress store, instead shuffle by the 8-bit keep mask
+          int           gaCompress32[ 256 ][  8 ];            // same for 32-bit lanes with vpermd
+#endif
+
+    // Bitset adjacency
+    const int    BITSET_WORDS  = MAX_5_WORDS / 64;      // uint64 per bitset; in practice 94 for words_alpha.txt
+          int    gnBitsetWords = 0;
+     uint64_t    gaLetterBits [ NUM_LETTERS ][ BITSET_WORDS ];          // words that contain this letter
+     uint64_t   *gpBitsets     = NULL;                  // forward neighbors of each word, i.e. only bits > word, gnBitsetWords per word
+     uint64_t   *gpBitsetLevel = NULL;                  // Per-thread candidates after choosing word1, word2, word3, gnBitsetWords per level
+
+    // Memoized completions
+    struct MemoPairs
+    {
+        int    nPairs;
+        short *pPairs;                                        // nPairs of (word3, word4) sorted by word3
+    };
+    const int    MEMO_PER_WORD = 512;                         // table room per word; in practice 1,272,060 unique 15 letter masks for words_alpha.txt's 5,977 words
+          int    gnMemoSlots   = 0;                           // power of 2, see PrepareMemo()
+          int    gnMemoShift   = 0;                           // 32 - log2( gnMemoSlots )
+          int    gnMemoMax     = 0;                           // masks memoized before the table is full, 3/4 of the slots
+    std::atomic<int>              *gpMemoKeys   = NULL;       // open addressing hash table: mask of 3 words, 0 = empty slot
+    std::atomic<const MemoPairs*> *gpMemoValues = NULL;       // NULL while the thread that claimed the slot fills it in
+    std::atomic<int>               gnMemoMasks( 0 );
+    std::atomic<int>               gnMemoSkips( 0 );          // completions computed without memoizing them, the table was full
+    const MemoPairs                gMemoNone = { 0, NULL };   // shared by every mask without completions
+          short  gaMemoAll  [ MAX_5_WORDS ];                  // 0 .. n-1
+          short *gpMemoWords = NULL;                          // Per-thread words disjoint from word0; word0, word1; ... in either direction, see ThreadRows()
+
+    // Subset convolution
+     uint32_t   *gpZeta = NULL;                               // 2^26 entries: number of words whose letters are a subset of the mask
+
+    // Rarest letter first
+          int    gaLetterOrder[ NUM_LETTERS   ];              // letters sorted by frequency, rarest first
+          int    gaRareHash   [ MAX_5_WORDS   ];              // gaHash remapped so bit 0 is the rarest letter
+          short  gaRareWords  [ MAX_5_WORDS   ];              // words bucketed by their rarest letter
+          int    gaRareStart  [ NUM_LETTERS+1 ];              // [letter,letter+1) is the range of gaRareWords for that bucket
+
+    // One job per missing letter
+    struct SplitJob
+    {
+        short  word0;                                         // the only word of the clique with the job's rarest letter
+        short  iLetter;                                       // the missing letter
+    };
+          int    gnSplitJobs  = 0;
+          SplitJob *gpSplitJobs = NULL;
+          int    gaSplitStart [ NUM_LETTERS+1 ];              // [letter,letter+1) is the range of gpSplitWords without that letter
+          short *gpSplitWords = NULL;                         // per missing letter, every word without it
+          short *gpSplitCands = NULL;                         // Per-thread survivors after choosing word0 .. word3, see ThreadRows()
 
+// Appends a new chunk to the thread's list of results
 // ======================================================================
-void Init()
+void NewChunk( ResultSink *pSink )
 {
-    memset( gaSolutions, 0, sizeof( gaSolutions ) );  // Scatter
+    ResultChunk *pChunk = (ResultChunk*) malloc( sizeof( ResultChunk ) );
+    if (!pChunk)
+        exit( printf( "ERROR: Couldn't allocate memory for %d solutions\n", pSink->nSolutions + CHUNK_SOLUTIONS ) );
+
+    pChunk->pNext      = NULL;
+    pChunk->nSolutions = 0;
+
+    if (pSink->pTail)
+        pSink->pTail->pNext = pChunk;
+    else
+        pSink->pHead        = pChunk;
+    pSink->pTail  = pChunk;
+    pSink->pWrite = pChunk->aWords;
+    pSink->nFree  = CHUNK_SOLUTIONS;
 }
 
-// Read raw word file where words are of varying length, assumes all words are lowercase
+// Returns where to write the NUM_WORDS words of the next solution
 // ======================================================================
-void Read4( const char *filename )
+inline short* AddSolution( int iThread )
 {
-    FILE *file   = fopen( filename, "rb" );
-    if ( !file )
-        exit( printf( "ERROR: Couldn't open input file: %s\n", filename ) );
+    ResultSink *pSink = &gaSinks[ iThread ];
+    if (!pSink->nFree)
+        NewChunk( pSink );
 
-    if (gnBufferSize >= sizeof(gaBufferText) - 2)
-        exit( printf( "ERROR: Couldn't allocate memory for file. %d KB > %d KB\n", (int)gnBufferSize/1024, (int)sizeof(gaBufferText)/1024 ) );
+    short *pSolution = pSink->pWrite;
+    pSink->pWrite += NUM_WORDS;
+    pSink->nFree--;
+    pSink->nSolutions++;
+    pSink->pTail->nSolutions++;
+    return pSolution;
+}
 
-    gnBufferSize = fread( gaBufferText, 1, sizeof(gaBufferText)-2, file );
-    gaBufferText[ gnBufferSize+0 ] = EOL_CHAR;
-    gaBufferText[ gnBufferSize+1 ] = 0;
+// Records one clique, or with -count only counts it by its missing letter
+// ======================================================================
+inline void Emit( int iThread, int word0, int word1, int word2, int word3, int word4 )
+{
+    if (gbCount)
+    {
+        int nMissing = ~(gaHash[ word0 ] | gaHash[ word1 ] | gaHash[ word2 ] | gaHash[ word3 ] | gaHash[ word4 ]) & ALL_LETTERS;
+        int nWeight  = gbAnagrams
+                     ? gaAnagrams[ word0 ] * gaAnagrams[ word1 ] * gaAnagrams[ word2 ] * gaAnagrams[ word3 ] * gaAnagrams[ word4 ]
+                     : 1;
+        gaSinks[ iThread ].nSolutions++;
+        gaSinks[ iThread ].nAnagrams += nWeight;
+        gaSinks[ iThread ].aMissing[ __builtin_ctz( nMissing ) ] += nWeight;
+        return;
+    }
 
-    fclose( file );
+    short  *pSolution    = AddSolution( iThread );
+            pSolution[0] = (short) word0;
+            pSolution[1] = (short) word1;
+            pSolution[2] = (short) word2;
+            pSolution[3] = (short) word3;
+            pSolution[4] = (short) word4;
 }
 
-// Parses dictionary reading all 5 letter words
+// -count without -anagrams: every survivor of the last level completes a clique, and no clique needs a weight,
+// so the leaves are added to the counters per missing letter instead of emitting each clique
 // ======================================================================
-void Parse()
+inline bool CountLeaves()
 {
-    char *pText = (char*) gaBufferText;
-    char *pEnd  = (char*) gaBufferText + gnBufferSize;
+    return gbCount && !gbAnagrams;
+}
 
-    int nTotalWords  = 0;
-    int nLengthWords = 0;
-    int nUniqueWords = 0;
-    int nDuplicates  = 0;
+// ======================================================================
+inline void AddLeaves( int iThread, int iLetter, int nLeaves )
+{
+    ResultSink *pSink = &gaSinks[ iThread ];
+    pSink->nSolutions          += nLeaves;
+    pSink->nAnagrams           += nLeaves;
+    pSink->aMissing[ iLetter ] += nLeaves;
+}
+
+// The survivors among the contiguous masks pHash miss exactly one letter outside nUsed: count each with the popcount kernel
+// ======================================================================
+inline void CountLeafHash( int iThread, const int *pHash, int nHash, int nUsed )
+{
+    for( int nFree = ~nUsed & ALL_LETTERS; nFree; nFree &= nFree - 1 )
+        AddLeaves( iThread, __builtin_ctz( nFree ), gpCount( pHash, nHash, nUsed | (nFree & -nFree) ) );
+}
+
+// Every word of pWords completes a clique with the letters of nUsed
+// ======================================================================
+inline void CountLeafWords( int iThread, const short *pWords, int nWords, int nUsed )
+{
+    for( int iWord = 0; iWord < nWords; ++iWord )
+        AddLeaves( iThread, __builtin_ctz( ~(nUsed | gaHash[ pWords[ iWord ] ]) & ALL_LETTERS ), 1 );
+}
+
+// Records nWords words of one solution, or with -count only counts it by its first missing letter
+// ======================================================================
+inline void WordEmit( WordSink *pSink, const int *pWords, int nWords, int iMissing )
+{
+    if (gbCount)
+    {
+        pSink->aMissing[ iMissing ]++;
+        pSink->nSolutions++;
+        return;
+    }
 
-    while (pText < pEnd)
+    if (pSink->nSolutions == pSink->nCapacity)
     {
-        char *eow = pText;
+        pSink->nCapacity = pSink->nCapacity ? 2*pSink->nCapacity : 1024;
+        pSink->pWords    = (int*) realloc( pSink->pWords, sizeof( int ) * nWords * pSink->nCapacity );
+        if (!pSink->pWords)
+            exit( printf( "ERROR: Couldn't allocate memory for %d solutions\n", pSink->nCapacity ) );
+    }
+    memcpy( pSink->pWords + nWords*pSink->nSolutions, pWords, sizeof( int ) * nWords );
+    pSink->nSolutions++;
+}
 
-        while (*eow != EOL_CHAR)
-            eow++;
+// Number of masks that don't share any letters with nMask
+// ======================================================================
+int CountScalar( const int *pHash, int nHash, int nMask )
+{
+    int nCount = 0;
+    for( int iHash = 0; iHash < nHash; ++iHash )
+        nCount += (pHash[ iHash ] & nMask) == 0;
+    return nCount;
+}
 
-        size_t len = (eow - pText);
-        *eow = 0;
+#if USE_SIMD
+// ======================================================================
+TARGET_AVX2 int CountAVX2( const int *pHash, int nHash, int nMask )
+{
+    const __m256i vMask = _mm256_set1_epi32( nMask );
+    const __m256i vZero = _mm256_setzero_si256();
 
-        if (len == NUM_CHARS)
-        {
-            int nHash = 0;
-            for( int iLetter = 0; iLetter < NUM_CHARS; ++iLetter )
-                nHash |= 1 << (pText[iLetter] - 'a');  // convert 7-bit ASCII string to 26-bit bit mask
+    int nCount = 0;
+    int iHash  = 0;
+    for( ; iHash + 8 <= nHash; iHash += 8 )
+    {
+        __m256i vValid = _mm256_cmpeq_epi32( _mm256_and_si256( _mm256_loadu_si256( (const __m256i*)(pHash + iHash) ), vMask ), vZero );
+        nCount += __builtin_popcount( _mm256_movemask_ps( _mm256_castsi256_ps( vValid ) ) );
+    }
+    return nCount + CountScalar( pHash + iHash, nHash - iHash, nMask );
+}
 
-            nLengthWords++;
-            gaWords[ nUniqueWords ] = pText;
-            gaHash [ nUniqueWords ] = nHash;
+// ======================================================================
+TARGET_AVX512 int CountAVX512( const int *pHash, int nHash, int nMask )
+{
+    const __m512i vMask = _mm512_set1_epi32( nMask );
 
-            if (__builtin_popcount(gaHash[nUniqueWords]) == NUM_CHARS)  // Only accept words with 5 letters, trivial reject words that have duplicate letters
-            {
-                bool found = false;  // if this hash already exists skip anagrams
-                for (int word = 0; word < nUniqueWords; ++word)
-                {
-                    if (gaHash[ nUniqueWords ] == gaHash[ word ])
-                    {
-                        found = true;
-                        nDuplicates++;
-                    }
-                }
-                if (!found)
-                    nUniqueWords++;
-            }
-        }
-        nTotalWords++;
-        pText = eow + EOL_SIZE;
+    int nCount = 0;
+    int iHash  = 0;
+    for( ; iHash + 16 <= nHash; iHash += 16 )
+        nCount += __builtin_popcount( _mm512_testn_epi32_mask( _mm512_loadu_si512( pHash + iHash ), vMask ) );
+    return nCount + CountScalar( pHash + iHash, nHash - iHash, nMask );
+}
+#endif // USE_SIMD
+
+// Copies the candidates that don't share any letters with nHash
+// ======================================================================
+int FilterScalar( const short *pIn, int nIn, int nHash, short *pOut )
+{
+    int nOut = 0;
+    for( int iIn = 0; iIn < nIn; ++iIn )
+    {
+        pOut[ nOut ] = pIn[ iIn ];
+        nOut += (gaHash[ pIn[ iIn ] ] & nHash) == 0; // branchless
     }
-    gnUniqueWords = nUniqueWords;
+    return nOut;
+}
 
-    printf( "%6d Total words\n"           , nTotalWords             );
-    printf( "%6d length %d words\n"       , nLengthWords, NUM_CHARS );
-    printf( "%6d duplicate %d words\n"    , nDuplicates , NUM_CHARS );
-    printf( "%6d unique %d letter words\n", nUniqueWords, NUM_CHARS );
+#if USE_SIMD
+// Tests 8 candidates at once: gather their masks, AND, then left pack the survivors with pshufb
+// ======================================================================
+TARGET_AVX2 int FilterAVX2( const short *pIn, int nIn, int nHash, short *pOut )
+{
+    const __m256i vHash = _mm256_set1_epi32( nHash );
+    const __m256i vZero = _mm256_setzero_si256();
+
+    int nOut = 0;
+    int iIn  = 0;
+    for( ; iIn + 8 <= nIn; iIn += 8 )
+    {
+        __m128i vWords = _mm_loadu_si128( (const __m128i*)(pIn + iIn) );
+        __m256i vMasks = _mm256_i32gather_epi32( gaHash, _mm256_cvtepi16_epi32( vWords ), 4 );
+        __m256i vValid = _mm256_cmpeq_epi32( _mm256_and_si256( vMasks, vHash ), vZero );
+        int     nKeep  = _mm256_movemask_ps( _mm256_castsi256_ps( vValid ) );
+
+        // Always stores 8 words; safe since nOut <= iIn
+        _mm_storeu_si128( (__m128i*)(pOut + nOut), _mm_shuffle_epi8( vWords, _mm_loadu_si128( (const __m128i*) gaCompress16[ nKeep ] ) ) );
+        nOut += __builtin_popcount( nKeep );
+    }
+    return nOut + FilterScalar( pIn + iIn, nIn - iIn, nHash, pOut + nOut );
 }
 
+// Tests 16 candidates at once: gather their masks, test, then compress store the survivors
 // ======================================================================
-void Prepare()
+TARGET_AVX512 int FilterAVX512( const short *pIn, int nIn, int nHash, short *pOut )
 {
-#pragma omp parallel for
-    for( short word0 = 0; word0 < gnUniqueWords; ++word0 )
+    const __m512i vHash = _mm512_set1_epi32( nHash );
+
+    int nOut = 0;
+    int iIn  = 0;
+    for( ; iIn + 16 <= nIn; iIn += 16 )
     {
-        short nNeighbors = 1; // See note below
+        __m512i   vWords = _mm512_cvtepi16_epi32( _mm256_loadu_si256( (const __m256i*)(pIn + iIn) ) );
+        __m512i   vMasks = _mm512_i32gather_epi32( vWords, gaHash, 4 );
+        __mmask16 nKeep  = _mm512_testn_epi32_mask( vMasks, vHash );
+        int       nKept  = __builtin_popcount( nKeep );
 
-        // Instead of starting from 0, if our dictionary of words is sorted we can start testing for candidates from the next word
-        for( short word1 = word0+1; word1 < gnUniqueWords; ++word1 )
-            if ((gaHash[word0] & gaHash[word1]) == 0)         // two words are unique if the bitwise AND of bitmasks is zero!
-                gaNeighbors[ word0 ][ nNeighbors++ ] = (short) word1;
+        _mm512_mask_cvtepi32_storeu_epi16( pOut + nOut, (__mmask16)((1u << nKept) - 1), _mm512_maskz_compress_epi32( nKeep, vWords ) );
+        nOut += nKept;
+    }
+    return nOut + FilterScalar( pIn + iIn, nIn - iIn, nHash, pOut + nOut );
+}
+#endif // USE_SIMD
 
-        gaNeighbors[ word0 ][0] = nNeighbors; // [1,n] for loop counters since[0] has list size
+// Copies the neighbors that don't share any letters with nHash.  A row of the DAG has its masks alongside, so there is nothing to gather
+// ======================================================================
+int FilterRowScalar( const short *pIn, const int *pInHash, int nIn, int nHash, short *pOut )
+{
+    int nOut = 0;
+    for( int iIn = 0; iIn < nIn; ++iIn )
+    {
+        pOut[ nOut ] = pIn[ iIn ];
+        nOut += (pInHash[ iIn ] & nHash) == 0; // branchless
     }
+    return nOut;
 }
 
+#if USE_SIMD
+// Tests 8 neighbors at once, left packs the survivors with pshufb
 // ======================================================================
-void Search3()
+TARGET_AVX2 int FilterRowAVX2( const short *pIn, const int *pInHash, int nIn, int nHash, short *pOut )
 {
-#pragma omp parallel for
-    for (int word0 = 0; word0 < gnUniqueWords; ++word0) // Every word effectively has a neighbor
+    const __m256i vHash = _mm256_set1_epi32( nHash );
+    const __m256i vZero = _mm256_setzero_si256();
+
+    int nOut = 0;
+    int iIn  = 0;
+    for( ; iIn + 8 <= nIn; iIn += 8 )
     {
-        int iThread = omp_get_thread_num();
+        __m256i vValid = _mm256_cmpeq_epi32( _mm256_and_si256( _mm256_loadu_si256( (const __m256i*)(pInHash + iIn) ), vHash ), vZero );
+        int     nKeep  = _mm256_movemask_ps( _mm256_castsi256_ps( vValid ) );
+        if (!nKeep) // almost every leaf of the DAG has no survivors
+            continue;
 
-        int nHash0   = 0 | gaHash[ word0 ];       // "previous" hash is zero
-        int nOffset1 = gaNeighbors[ word0 ][ 0 ];
+        // Always stores 8 words, pOut needs 8 entries of slack
+        __m128i vWords = _mm_loadu_si128( (const __m128i*)(pIn + iIn) );
+        _mm_storeu_si128( (__m128i*)(pOut + nOut), _mm_shuffle_epi8( vWords, _mm_loadu_si128( (const __m128i*) gaCompress16[ nKeep ] ) ) );
+        nOut += __builtin_popcount( nKeep );
+    }
+    return nOut + FilterRowScalar( pIn + iIn, pInHash + iIn, nIn - iIn, nHash, pOut + nOut );
+}
 
-        for (int iOffset1 = 1; iOffset1 < nOffset1; ++iOffset1)
-        {
-            int word1 = gaNeighbors[ word0 ][ iOffset1 ];
-            int hash1 = gaHash[ word1 ] & nHash0;
-            if( hash1 )
-                continue;
+// Tests 16 neighbors at once and compress stores the survivors
+// ======================================================================
+TARGET_AVX512 int FilterRowAVX512( const short *pIn, const int *pInHash, int nIn, int nHash, short *pOut )
+{
+    const __m512i vHash = _mm512_set1_epi32( nHash );
+
+    int nOut = 0;
+    int iIn  = 0;
+    for( ; iIn + 16 <= nIn; iIn += 16 )
+    {
+        __mmask16 nKeep = _mm512_testn_epi32_mask( _mm512_loadu_si512( pInHash + iIn ), vHash );
+        if (!nKeep)
+            continue;
 
-            int nHash1   = nHash0 | gaHash[ word1 ];
-            int nOffset2 = gaNeighbors[ word1 ][ 0 ];
+        int nKept = __builtin_popcount( nKeep );
+        __m512i vWords = _mm512_cvtepi16_epi32( _mm256_loadu_si256( (const __m256i*)(pIn + iIn) ) );
+        _mm512_mask_cvtepi32_storeu_epi16( pOut + nOut, (__mmask16)((1u << nKept) - 1), _mm512_maskz_compress_epi32( nKeep, vWords ) );
+        nOut += nKept;
+    }
+    return nOut + FilterRowScalar( pIn + iIn, pInHash + iIn, nIn - iIn, nHash, pOut + nOut );
+}
+#endif // USE_SIMD
 
-            for (int iOffset2 = 1; iOffset2 < nOffset2; ++iOffset2)
+// Neighbors of word0 starting at word1; only counts if pOut is NULL
+// ======================================================================
+int PrepareRowScalar( int word0, int word1, short *pOut, int *pOutHash )
+{
+    int nOut = 0;
+    for( ; word1 < gnUniqueWords; ++word1 )
+        if ((gaHash[word0] & gaHash[word1]) == 0) // two words are unique if the bitwise AND of bitmasks is zero!
+        {
+            if (pOut)
             {
-                int word2 = gaNeighbors[ word1 ][ iOffset2 ];
-                int hash2 = nHash1 & gaHash[ word2 ];
-                if( hash2 )
-                    continue;
+                pOut    [ nOut ] = (short) word1;
+                pOutHash[ nOut ] = gaHash[ word1 ];
+            }
+            nOut++;
+        }
+    return nOut;
+}
 
-                int nHash2   = nHash1 | gaHash[ word2 ];
-                int nOffset3 = gaNeighbors[ word2 ][ 0 ];
+#if USE_SIMD
+// Tests 8 words at once, left packs the word numbers with pshufb and the masks with a permute
+// ======================================================================
+TARGET_AVX2 int PrepareRowAVX2( int word0, int word1, short *pOut, int *pOutHash )
+{
+    const __m256i vHash  = _mm256_set1_epi32( gaHash[ word0 ] );
+    const __m256i vZero  = _mm256_setzero_si256();
+          __m128i vWords = _mm_add_epi16( _mm_set1_epi16( (short) word1 ), _mm_setr_epi16( 0, 1, 2, 3, 4, 5, 6, 7 ) );
 
-                for (int iOffset3 = 1; iOffset3 < nOffset3; ++iOffset3)
-                {
-                    int word3 = gaNeighbors[ word2 ][ iOffset3 ];
-                    int hash3 = nHash2 & gaHash[ word3 ];
-                    if( hash3 )
-                        continue;
+    int nOut = 0;
+    for( ; word1 + 8 <= gnUniqueWords; word1 += 8, vWords = _mm_add_epi16( vWords, _mm_set1_epi16( 8 ) ) )
+    {
+        __m256i vMasks = _mm256_loadu_si256( (const __m256i*)(gaHash + word1) );
+        __m256i vValid = _mm256_cmpeq_epi32( _mm256_and_si256( vMasks, vHash ), vZero );
+        int     nKeep  = _mm256_movemask_ps( _mm256_castsi256_ps( vValid ) );
 
-                    int nHash3   = nHash2 | gaHash[ word3 ];
-                    int nOffset4 = gaNeighbors[ word3 ][ 0 ]; // [0] = length of valid neighbors
+        if (pOut)
+        {
+            _mm_storeu_si128   ( (__m128i*)(pOut     + nOut), _mm_shuffle_epi8( vWords, _mm_loadu_si128( (const __m128i*) gaCompress16[ nKeep ] ) ) );
+            _mm256_storeu_si256( (__m256i*)(pOutHash + nOut), _mm256_permutevar8x32_epi32( vMasks, _mm256_loadu_si256( (const __m256i*) gaCompress32[ nKeep ] ) ) );
+        }
+        nOut += __builtin_popcount( nKeep );
+    }
+    return nOut + PrepareRowScalar( word0, word1, pOut ? pOut + nOut : NULL, pOut ? pOutHash + nOut : NULL );
+}
 
-                    for (int iOffset4 = 1; iOffset4 < nOffset4; ++iOffset4)
-                    {
-                        int word4 = gaNeighbors[ word3 ][ iOffset4 ];
-                        int hash4 = nHash3 & gaHash[ word4 ];
-                        if( hash4 )
-                            continue;
-
-                        short   iSolutions   = gaSolutions[ iThread ];
-                        short  *pSolution    = &gaOutput[ iThread ][ iSolutions*NUM_WORDS ];
-                                pSolution[0] = (short) word0;
-                                pSolution[1] = (short) word1;
-                                pSolution[2] = (short) word2;
-                                pSolution[3] = (short) word3;
-                                pSolution[4] = (short) word4;
-                        ++gaSolutions[ iThread ];
-                    }
-                }
-            }
+// Tests 16 words at once and compress stores the word numbers and masks
+// ======================================================================
+TARGET_AVX512 int PrepareRowAVX512( int word0, int word1, short *pOut, int *pOutHash )
+{
+    const __m512i vHash  = _mm512_set1_epi32( gaHash[ word0 ] );
+          __m512i vWords = _mm512_add_epi32( _mm512_set1_epi32( word1 ), _mm512_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 ) );
+
+    int nOut = 0;
+    for( ; word1 + 16 <= gnUniqueWords; word1 += 16, vWords = _mm512_add_epi32( vWords, _mm512_set1_epi32( 16 ) ) )
+    {
+        __m512i   vMasks = _mm512_loadu_si512( gaHash + word1 );
+        __mmask16 nKeep  = _mm512_testn_epi32_mask( vMasks, vHash );
+        int       nKept  = __builtin_popcount( nKeep );
+
+        if (pOut)
+        {
+            _mm512_mask_cvtepi32_storeu_epi16( pOut + nOut, (__mmask16)((1u << nKept) - 1), _mm512_maskz_compress_epi32( nKeep, vWords ) );
+            _mm512_mask_compressstoreu_epi32 ( pOutHash + nOut, nKeep, vMasks );
         }
+        nOut += nKept;
     }
+    return nOut + PrepareRowScalar( word0, word1, pOut ? pOut + nOut : NULL, pOut ? pOutHash + nOut : NULL );
 }
+#endif // USE_SIMD
 
 // ======================================================================
-void Solutions()
+int DetectSimd()
 {
-    // Gather
-    int nTotal   = 0;
-    int nThreads = 0;
+#if USE_SIMD
+  #ifdef _MSC_VER
+    int aRegs[4];
+    __cpuid( aRegs, 1 );
+    if (!(aRegs[2] & (1 << 27)))                    // OSXSAVE
+        return SIMD_SCALAR;
 
-    for (int iThread = 0; iThread < MAX_THREADS; ++iThread)
+    unsigned long long nXCR0 = _xgetbv( 0 );
+    __cpuidex( aRegs, 7, 0 );
+    if ((aRegs[1] & (1 << 16)) && ((nXCR0 & 0xE6) == 0xE6)) // AVX512F, OS saves ZMM and opmask state
+        return SIMD_AVX512;
+    if ((aRegs[1] & (1 <<  5)) && ((nXCR0 & 0x06) == 0x06)) // AVX2, OS saves YMM state
+        return SIMD_AVX2;
+  #else
+    if (__builtin_cpu_supports( "avx512f" ))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports( "avx2" ))
+        return SIMD_AVX2;
+  #endif
+#endif
+    return SIMD_SCALAR;
+}
+
+// ======================================================================
+void Init()
+{
+    memset( gaSinks    , 0, sizeof( gaSinks     ) );  // Scatter
+    memset( gaMaskKeys , 0, sizeof( gaMaskKeys  ) );
+
+    int nSimd = DetectSimd();
+    if (gnSimd > nSimd)
+        gnSimd = nSimd;
+
+    gpFilter     = FilterScalar;
+    gpFilterRow  = FilterRowScalar;
+    gpPrepareRow = PrepareRowScalar;
+    gpCount      = CountScalar;
+#if USE_SIMD
+    for( int nKeep = 0; nKeep < 256; ++nKeep ) // pshufb control to left pack the kept 16-bit lanes
+    {
+        int iOut = 0;
+        for( int iLane = 0; iLane < 8; ++iLane )
+            if (nKeep & (1 << iLane))
+            {
+                gaCompress16[ nKeep ][ iOut++ ] = (unsigned char)(iLane*2 + 0);
+                gaCompress16[ nKeep ][ iOut++ ] = (unsigned char)(iLane*2 + 1);
+            }
+        while (iOut < 16)
+            gaCompress16[ nKeep ][ iOut++ ] = 0x80; // zero
+
+        iOut = 0;
+        for( int iLane = 0; iLane < 8; ++iLane )
+            if (nKeep & (1 << iLane))
+                gaCompress32[ nKeep ][ iOut++ ] = iLane;
+        while (iOut < 8)
+            gaCompress32[ nKeep ][ iOut++ ] = 0;
+    }
+
+    if (gnSimd == SIMD_AVX2  ) gpFilter = FilterAVX2;
+    if (gnSimd == SIMD_AVX512) gpFilter = FilterAVX512;
+    if (gnSimd == SIMD_AVX2  ) gpFilterRow  = FilterRowAVX2;
+    if (gnSimd == SIMD_AVX512) gpFilterRow  = FilterRowAVX512;
+    if (gnSimd == SIMD_AVX2  ) gpPrepareRow = PrepareRowAVX2;
+    if (gnSimd == SIMD_AVX512) gpPrepareRow = PrepareRowAVX512;
+    if (gnSimd == SIMD_AVX2  ) gpCount      = CountAVX2;
+    if (gnSimd == SIMD_AVX512) gpCount      = CountAVX512;
+#endif
+    printf( "Using %s kernels\n", gaSimdNames[ gnSimd ] );
+}
+
+// Maps the whole file read-only, returns NULL on failure
+// ======================================================================
+const void* MapView( const char *filename, size_t nSize )
+{
+    void *pView = NULL;
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA( filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if (hFile == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    HANDLE hMap = CreateFileMappingA( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+    CloseHandle( hFile );
+    if (!hMap)
+        return NULL;
+
+    pView = MapViewOfFile( hMap, FILE_MAP_READ, 0, 0, 0 );
+    CloseHandle( hMap ); // the view keeps the mapping alive
+#else
+    int hFile = open( filename, O_RDONLY );
+    if (hFile < 0)
+        return NULL;
+
+    pView = mmap( NULL, nSize, PROT_READ, MAP_PRIVATE, hFile, 0 );
+    close( hFile ); // the mapping keeps the file alive
+    if (pView == MAP_FAILED)
+        pView = NULL;
+#endif
+    return pView;
+}
+
+// ======================================================================
+void UnmapView( const void *pView, size_t nSize )
+{
+#ifdef _WIN32
+    (void) nSize;
+    UnmapViewOfFile( pView );
+#else
+    munmap( (void*) pView, nSize );
+#endif
+}
+
+// Maps the whole file read-only so it is parsed in place, and repeated runs are served from the page cache
+// ======================================================================
+bool MapFile( const char *filename, size_t nSize )
+{
+    const void *pView = MapView( filename, nSize );
+    if (!pView)
+        return false;
+
+    // NOTE: Never unmapped since gaWords[] point into the file
+    gpBufferText = (const char*) pView;
+    gnBufferSize = nSize;
+    return true;
+}
+
+// Fallback for pipes, i.e. filename "-" is stdin, or if the file can't be mapped
+// ======================================================================
+void ReadStream( const char *filename )
+{
+    bool  bStdin = (strcmp( filename, "-" ) == 0);
+    FILE *file   = bStdin ? stdin : fopen( filename, "rb" );
+    if ( !file )
+        exit( printf( "ERROR: Couldn't open input file: %s\n", filename ) );
+#ifdef _WIN32
+    if (bStdin)
+        _setmode( _fileno( stdin ), _O_BINARY ); // keep CR LF
+#endif
+
+    size_t nCapacity = 4 * 1024 * 1024;
+    size_t nSize     = 0;
+    char  *pText     = (char*) malloc( nCapacity );
+
+    for(;;)
+    {
+        if (!pText)
+            exit( printf( "ERROR: Couldn't allocate memory for file. %d KB\n", (int)(nCapacity/1024) ) );
+
+        nSize += fread( pText + nSize, 1, nCapacity - nSize, file );
+        if (nSize < nCapacity)
+            break;
+
+        nCapacity *= 2;
+        pText      = (char*) realloc( pText, nCapacity );
+    }
+
+    if (!bStdin)
+        fclose( file );
+
+    gpBufferText = pText;
+    gnBufferSize = nSize;
+}
+
+// Read raw word file where words are of varying length
+// ======================================================================
+void Read4( const char *filename )
+{
+    struct stat info;
+    if ((stat( filename, &info ) == 0) && ((info.st_mode & S_IFMT) == S_IFREG) && (info.st_size > 0))
+        if (MapFile( filename, (size_t) info.st_size ))
+            return;
+
+    ReadStream( filename );
+}
+
+// Fibonacci hashing of a letter mask into a power of 2 table, nShift = 32 - log2( table size )
+// ======================================================================
+inline int HashSlot( int nMask, int nShift )
+{
+    return (int)(((unsigned int) nMask * 0x9E3779B1u) >> nShift);
+}
+
+// Returns the slot in gaMaskKeys with this mask, or an empty slot
+// ======================================================================
+inline int MaskFind( int nMask )
+{
+    int iSlot = HashSlot( nMask, MASK_SHIFT );
+    while (gaMaskKeys[ iSlot ] && (gaMaskKeys[ iSlot ] != nMask))
+        iSlot = (iSlot + 1) & (MASK_SLOTS - 1);
+    return iSlot;
+}
+
+    // Parsing
+    const int    PARSE_CHUNK   = 1024*1024;             // bytes per parallel parse job
+
+          int    gnParseLengths = 1 << NUM_CHARS;       // bit per word length ParseLine() accepts
+
+    template< typename Mask >                           // int for a-z, or the letter mask of a Puzzle<>
+    struct ParseChunk
+    {
+        const char  *pBegin;                            // [begin,end) starts at a line and ends after a LF
+        const char  *pEnd;
+              int    nTotalWords;
+              int    nLengthWords;
+              int    nWords;                            // words of an accepted length with unique letters, in file order
+              int    nCapacity;
+        const char **ppWords;
+              Mask  *pHash;
+    };
+
+// Appends an accepted word to the chunk
+// ======================================================================
+template< typename Mask >
+inline void ChunkAdd( ParseChunk< Mask > *pChunk, const char *pText, Mask nHash )
+{
+    if (pChunk->nWords == pChunk->nCapacity)
+    {
+        pChunk->nCapacity = pChunk->nCapacity ? 2*pChunk->nCapacity : 1024;
+        pChunk->ppWords   = (const char**) realloc( pChunk->ppWords, pChunk->nCapacity * sizeof( const char* ) );
+        pChunk->pHash     = (Mask       *) realloc( pChunk->pHash  , pChunk->nCapacity * sizeof( Mask        ) );
+        if (!pChunk->ppWords || !pChunk->pHash)
+            exit( printf( "ERROR: Couldn't allocate memory for %d words\n", pChunk->nCapacity ) );
+    }
+    pChunk->ppWords[ pChunk->nWords ] = pText;
+    pChunk->pHash  [ pChunk->nWords ] = nHash;
+    pChunk->nWords++;
+}
+
+// Tokenizes one line; handles both CR LF and LF line endings at runtime
+// ======================================================================
+inline void ParseLine( ParseChunk< int > *pChunk, const char *pText, const char *eol )
+{
+    size_t len = (eol - pText);
+    if (len && (eol[-1] == '\r'))
+        len--;
+
+    pChunk->nTotalWords++;
+    if ((len >= 32) || !((gnParseLengths >> len) & 1))
+        return;
+
+    pChunk->nLengthWords++;
+
+    int nHash = 0;
+    for( int iLetter = 0; iLetter < (int) len; ++iLetter )
     {
-        nTotal     +=  gaSolutions[ iThread ]     ;
-        nThreads   += (gaSolutions[ iThread ] > 0);
+        unsigned int nLetter = (unsigned char) pText[iLetter] - 'a';
+        if (nLetter >= NUM_LETTERS)                     // assumes all words are lowercase, skip anything else
+            return;
+        nHash |= 1 << nLetter;                          // convert 7-bit ASCII string to 26-bit bit mask
+    }
+
+    if (__builtin_popcount(nHash) != (int) len)          // Only accept words with len distinct letters, trivial reject words that have duplicate letters
+        return;
+
+    ChunkAdd( pChunk, pText, nHash );
+}
 
-        if (gaSolutions[ iThread ] > 0)
-            printf( "Thread %d found %d solutions:\n", iThread, gaSolutions[ iThread ] );
+// Finds the LF of every line in the chunk 16 bytes at a time, and tokenizes each line with Line()
+// ======================================================================
+template< typename Mask, void (*Line)( ParseChunk< Mask > *pChunk, const char *pText, const char *eol ) >
+void ParseChunkLines( ParseChunk< Mask > *pChunk )
+{
+    const char *pText = pChunk->pBegin;
+    const char *pEnd  = pChunk->pEnd;
+    const char *pLine = pText;
 
-        for (int iSolution = 0; iSolution < gaSolutions[ iThread ]; ++iSolution)
+#if USE_SIMD // SSE2 is always present on x64
+    const __m128i vEOL = _mm_set1_epi8( '\n' );
+    for( ; pText + 16 <= pEnd; pText += 16 )
+    {
+        unsigned int nEOL = _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*) pText ), vEOL ) );
+        for( ; nEOL; nEOL &= nEOL - 1 )
         {
-            short *pWord = &gaOutput[ iThread ][ iSolution*NUM_WORDS ];
-            printf( "    %s, %s, %s, %s, %s,\n", gaWords[ pWord[0] ], gaWords[ pWord[1] ], gaWords[ pWord[2] ], gaWords[ pWord[3] ], gaWords[ pWord[4] ] );
+            const char *eol = pText + __builtin_ctz( nEOL );
+            Line( pChunk, pLine, eol );
+            pLine = eol + 1;
         }
     }
+#endif
+    for( ; pText < pEnd; ++pText )
+        if (*pText == '\n')
+        {
+            Line( pChunk, pLine, pText );
+            pLine = pText + 1;
+        }
 
-    printf( "Solutions: %d   \n", nTotal   );
-    printf( "Threads with solutions: %d\n", nThreads );
+    if (pLine < pEnd) // last line may not have an EOL
+        Line( pChunk, pLine, pEnd );
 }
 
+// Splits the buffer at line boundaries and tokenizes the chunks in parallel
 // ======================================================================
-int main( int nArg, char *aArg[] )
+template< typename Mask, void (*Line)( ParseChunk< Mask > *pChunk, const char *pText, const char *eol ) >
+ParseChunk< Mask >* ScanChunks( int *pNumChunks )
 {
-    auto begin = std::chrono::high_resolution_clock::now();
+    int nChunks = *pNumChunks = (int)(gnBufferSize / PARSE_CHUNK) + 1;
 
-        int gnCurThreads = 0; // auto-detect, use max threads
-        if (nArg > 1)
-            gnCurThreads = atoi( aArg[ 1 ] );
+    ParseChunk< Mask > *pChunks = (ParseChunk< Mask >*) calloc( nChunks, sizeof( ParseChunk< Mask > ) );
+    if (!pChunks)
+        exit( printf( "ERROR: Couldn't allocate memory for %d chunks\n", nChunks ) );
 
-        int gnMaxThreads = omp_get_max_threads(); // omp_get_num_procs();
-        omp_set_num_threads( gnCurThreads );
-        gnCurThreads = gnCurThreads ? gnCurThreads : gnMaxThreads;
-        printf( "Using %d / %d threads\n", gnCurThreads, gnMaxThreads );
+    const char *pText = gpBufferText;
+    const char *pEnd  = gpBufferText + gnBufferSize;
 
-        Init();
-        Read4( (nArg > 2) ? aArg[2] : "words_alpha.txt" ); // NOTE: words_alpha.txt (in MS-DOS format) has varying lengths of non-unique words
-        Parse();
+    for( int iChunk = 0; iChunk < nChunks; ++iChunk )
+    {
+        const char *pSplit = gpBufferText + (gnBufferSize * (iChunk + 1)) / nChunks;
+        if (pSplit < pText)
+            pSplit = pText;
+
+        const char *eol = (const char*) memchr( pSplit, '\n', pEnd - pSplit );
+        pChunks[ iChunk ].pBegin = pText;
+        pChunks[ iChunk ].pEnd   = pText = (eol && (iChunk < nChunks-1)) ? eol + 1 : pEnd;
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for( int iChunk = 0; iChunk < nChunks; ++iChunk )
+        ParseChunkLines< Mask, Line >( &pChunks[ iChunk ] );
+
+    return pChunks;
+}
+
+// Parses dictionary reading all 5 letter words.
+// The chunks are merged in file order so the first word of each anagram group is kept.
+// Returns false if there are more than MAX_5_WORDS unique words, see main()
+// ======================================================================
+bool Parse()
+{
+    int                nChunks = 0;
+    ParseChunk< int > *pChunks = ScanChunks< int, ParseLine >( &nChunks );
+
+    int nTotalWords  = 0;
+    int nLengthWords = 0;
+    int nUniqueWords = 0;
+    int nDuplicates  = 0;
+
+    static int aAnagramTail[ MAX_5_WORDS ];
+    int nAnagramWords = 0;
+    int nAnagramMax   = 0;
+
+    for( int iChunk = 0; iChunk < nChunks; ++iChunk )
+    {
+        ParseChunk< int > *pChunk = &pChunks[ iChunk ];
+        nTotalWords  += pChunk->nTotalWords;
+        nLengthWords += pChunk->nLengthWords;
+
+        if (nAnagramWords + pChunk->nWords > nAnagramMax)
+        {
+            nAnagramMax = 2*(nAnagramWords + pChunk->nWords);
+            gpAnagramWords = (const char**) realloc( (void*) gpAnagramWords, nAnagramMax * sizeof( gpAnagramWords[0] ) );
+            gpAnagramNext  = (int        *) realloc(         gpAnagramNext , nAnagramMax * sizeof( gpAnagramNext [0] ) );
+            if (!gpAnagramWords || !gpAnagramNext)
+                exit( printf( "ERROR: Couldn't allocate memory for %d anagrams\n", nAnagramMax ) );
+        }
+
+        for( int iWord = 0; iWord < pChunk->nWords; ++iWord )
+        {
+            gpAnagramWords[ nAnagramWords ] = pChunk->ppWords[ iWord ];
+            gpAnagramNext [ nAnagramWords ] = -1;
+
+            int nHash = pChunk->pHash[ iWord ];
+            int iSlot = MaskFind( nHash );  // if this hash already exists skip anagrams
+            if (gaMaskKeys[ iSlot ])
+            {
+                int word = gaMaskWord[ iSlot ];
+                nDuplicates++;
+                gaAnagrams[ word ]++;
+                gpAnagramNext[ aAnagramTail[ word ] ] = nAnagramWords;
+                aAnagramTail[ word ] = nAnagramWords;
+            }
+            else
+            {
+                if (nUniqueWords >= MAX_5_WORDS)
+                {
+                    for( ; iChunk < nChunks; ++iChunk )
+                    {
+                        free( pChunks[ iChunk ].ppWords );
+                        free( pChunks[ iChunk ].pHash   );
+                    }
+                    free( pChunks );
+                    return false;
+                }
+
+                gaMaskKeys[ iSlot ]     = nHash;
+                gaMaskWord[ iSlot ]     = (short) nUniqueWords;
+                gaWords[ nUniqueWords ] = pChunk->ppWords[ iWord ];
+                gaHash [ nUniqueWords ] = nHash;
+                gaAnagrams[ nUniqueWords ] = 1;
+                gaAnagramHead[ nUniqueWords ] = nAnagramWords;
+                aAnagramTail [ nUniqueWords ] = nAnagramWords;
+                nUniqueWords++;
+            }
+            nAnagramWords++;
+        }
+
+        free( pChunk->ppWords );
+        free( pChunk->pHash   );
+    }
+    free( pChunks );
+    gnUniqueWords  = nUniqueWords;
+    gnAnagramWords = nAnagramWords;
+
+    printf( "%6d Total words\n"           , nTotalWords             );
+    printf( "%6d length %d words\n"       , nLengthWords, NUM_CHARS );
+    printf( "%6d duplicate %d words\n"    , nDuplicates , NUM_CHARS );
+    printf( "%6d unique %d letter words\n", nUniqueWords, NUM_CHARS );
+    return true;
+}
+
+// Calls Row( iThread, word0 ) for every word in parallel.
+// Instead of starting from 0, if our dictionary of words is sorted we can start testing for candidates from the next word.
+// This makes the cost of row word0 proportional to (n - word0), so each work item is a pair of rows
+// word0 and n-1-word0 that together always cost n.
+// ======================================================================
+template< typename RowFunc >
+void ForFolds( int nWords, RowFunc Row )
+{
+    int nFolds = (nWords + 1) / 2;
+
+#pragma omp parallel for
+    for( int iFold = 0; iFold < nFolds; ++iFold )
+    {
+        int iThread = omp_get_thread_num();
+
+        for( int iRow = 0; iRow < 2; ++iRow )
+        {
+            int word0 = iRow ? (nWords - 1 - iFold) : iFold;
+            if (iRow && (word0 == iFold))
+                break;
+
+            Row( iThread, word0 );
+        }
+    }
+}
+
+// Turns the row lengths in pStart[ 1 .. nWords ] into CSR offsets, returns the longest row
+// ======================================================================
+int StartRows( int *pStart, int nWords )
+{
+    int nMaxRow = 0;
+    pStart[ 0 ] = 0;
+    for( int word0 = 0; word0 < nWords; ++word0 )
+    {
+        if (nMaxRow < pStart[ word0+1 ])
+            nMaxRow = pStart[ word0+1 ];
+        if ((int64_t) pStart[ word0+1 ] + pStart[ word0 ] > 0x7FFFFFFF)
+            exit( printf( "ERROR: More than 2^31 neighbors\n" ) );
+        pStart[ word0+1 ] += pStart[ word0 ];
+    }
+    return nMaxRow;
+}
+
+// Builds the DAG of forward neighbors in compressed sparse row format.
+// Pass 1 counts the neighbors of each word, pass 2 fills them in at the prefix sum of the counts.
+// ======================================================================
+void Prepare()
+{
+    if (gbGraphValid) // already built for these labels, or loaded from the cache
+        return;
+
+    if (!gbGraphMapped)
+    {
+        free( gpNeighbors    ); // rebuilding after Prune()
+        free( gpNeighborHash );
+    }
+    gbGraphMapped = false;
+
+    ForFolds( gnUniqueWords, []( int, int word0 )
+    {
+        gaNeighborStart[ word0+1 ] = gpPrepareRow( word0, word0+1, NULL, NULL );
+    } );
+
+    int nMaxNeighbors = StartRows( gaNeighborStart, gnUniqueWords );
+    if (nMaxNeighbors >= MAX_NEIGHBORS)
+        exit( printf( "ERROR: A word has %d neighbors > %d\n", nMaxNeighbors, MAX_NEIGHBORS ) );
+    gnNeighbors = gaNeighborStart[ gnUniqueWords ];
+
+    gpNeighbors    = (short*) malloc( sizeof( short ) * (gnNeighbors + 1) );
+    gpNeighborHash = (int  *) malloc( sizeof( int   ) * (gnNeighbors + 1) );
+    if (!gpNeighbors || !gpNeighborHash)
+        exit( printf( "ERROR: Couldn't allocate memory for %d neighbors\n", gnNeighbors ) );
+
+    // SIMD kernels overshoot, so fill a scratch row then copy it
+    gnPrepareRow      = nMaxNeighbors + 16;
+    gpPrepareRows     = (short*) malloc( sizeof( short ) * gnPrepareRow * omp_get_max_threads() );
+    gpPrepareRowsHash = (int  *) malloc( sizeof( int   ) * gnPrepareRow * omp_get_max_threads() );
+    if (!gpPrepareRows || !gpPrepareRowsHash)
+        exit( printf( "ERROR: Couldn't allocate memory for %d neighbors per thread\n", gnPrepareRow ) );
+
+    ForFolds( gnUniqueWords, []( int iThread, int word0 )
+    {
+        short *pRow       = gpPrepareRows     + (size_t) iThread * gnPrepareRow;
+        int   *pRowHash   = gpPrepareRowsHash + (size_t) iThread * gnPrepareRow;
+        int    nNeighbors = gpPrepareRow( word0, word0+1, pRow, pRowHash );
+        memcpy( gpNeighbors    + gaNeighborStart[ word0 ], pRow    , nNeighbors * sizeof( short ) );
+        memcpy( gpNeighborHash + gaNeighborStart[ word0 ], pRowHash, nNeighbors * sizeof( int   ) );
+    } );
+
+    free( gpPrepareRows     );
+    free( gpPrepareRowsHash );
+    gpPrepareRows     = NULL;
+    gpPrepareRowsHash = NULL;
+
+    gbGraphValid = true;
+    printf( "%6d neighbors, max %d per word\n", gnNeighbors, nMaxNeighbors );
+}
+
+// Renumbers the words: new word i is old word pOrder[i].  Words missing from pOrder are removed.
+// NOTE: Invalidates the neighbor graph, call Prepare() again
+// ======================================================================
+void Relabel( const short *pOrder, int nWords )
+{
+    static const char *aWords   [ MAX_5_WORDS ];
+    static       int   aHash    [ MAX_5_WORDS ];
+    static       int   aAnagrams[ MAX_5_WORDS ];
+    static       int   aHead    [ MAX_5_WORDS ];
+
+    for( int word = 0; word < nWords; ++word )
+    {
+        aWords   [ word ] = gaWords      [ pOrder[ word ] ];
+        aHash    [ word ] = gaHash       [ pOrder[ word ] ];
+        aAnagrams[ word ] = gaAnagrams   [ pOrder[ word ] ];
+        aHead    [ word ] = gaAnagramHead[ pOrder[ word ] ];
+    }
+    memcpy( gaWords      , aWords   , nWords * sizeof( gaWords      [0] ) );
+    memcpy( gaHash       , aHash    , nWords * sizeof( gaHash       [0] ) );
+    memcpy( gaAnagrams   , aAnagrams, nWords * sizeof( gaAnagrams   [0] ) );
+    memcpy( gaAnagramHead, aHead    , nWords * sizeof( gaAnagramHead[0] ) );
+    gnUniqueWords = nWords;
+    gbGraphValid  = false;
+}
+
+// 64-bit checksum of the dictionary or a cache section.  Fletcher sums in 16 independent lanes of 32 bits,
+// so the compiler vectorizes it and it runs at memory speed.  Only meant to catch a changed or damaged file.
+// ======================================================================
+uint64_t Checksum( const char *pBytes, size_t nSize )
+{
+    const int LANES = 16;
+    uint32_t  aSum1[ LANES ] = { 0 };
+    uint32_t  aSum2[ LANES ] = { 0 };                         // sum of the running sums, so the order of the bytes matters
+    size_t    iByte = 0;
+
+    for( ; iByte + sizeof( aSum1 ) <= nSize; iByte += sizeof( aSum1 ) )
+    {
+        uint32_t aWord[ LANES ];
+        memcpy( aWord, pBytes + iByte, sizeof( aWord ) );
+        for( int iLane = 0; iLane < LANES; ++iLane )
+        {
+            aSum1[ iLane ] += aWord[ iLane ];
+            aSum2[ iLane ] += aSum1[ iLane ];
+        }
+    }
+
+    uint64_t nHash = 0xCBF29CE484222325ull ^ nSize;
+    for( int iLane = 0; iLane < LANES; ++iLane )
+    {
+        nHash  = (nHash ^ (((uint64_t) aSum2[ iLane ] << 32) | aSum1[ iLane ])) * 0x100000001B3ull;
+        nHash ^= nHash >> 29;
+    }
+    for( ; iByte < nSize; ++iByte )
+        nHash = (nHash ^ (unsigned char) pBytes[ iByte ]) * 0x100000001B3ull;
+
+    return nHash;
+}
+
+// Bytes of data in each section, before padding
+// ======================================================================
+void CacheSizes( const CacheHeader *pHeader, size_t *pSize )
+{
+    int nStarts = pHeader->nGraph ? pHeader->nUniqueWords + 1 : 0;
+
+    pSize[ CACHE_WORD_OFFSET    ] = sizeof( uint32_t ) * pHeader->nUniqueWords;
+    pSize[ CACHE_HASH           ] = sizeof( int      ) * pHeader->nUniqueWords;
+    pSize[ CACHE_ANAGRAMS       ] = sizeof( int      ) * pHeader->nUniqueWords;
+    pSize[ CACHE_ANAGRAM_HEAD   ] = sizeof( int      ) * pHeader->nUniqueWords;
+    pSize[ CACHE_ANAGRAM_OFFSET ] = sizeof( uint32_t ) * pHeader->nAnagramWords;
+    pSize[ CACHE_ANAGRAM_NEXT   ] = sizeof( int      ) * pHeader->nAnagramWords;
+    pSize[ CACHE_NEIGHBOR_START ] = sizeof( int      ) * nStarts;
+    pSize[ CACHE_NEIGHBORS      ] = sizeof( short    ) * pHeader->nNeighbors;
+    pSize[ CACHE_NEIGHBOR_HASH  ] = sizeof( int      ) * pHeader->nNeighbors;
+}
+
+// Fills in the section offsets from the counts in the header
+// ======================================================================
+void CacheLayout( CacheHeader *pHeader )
+{
+    size_t aSize[ NUM_CACHE_SECTIONS ];
+    CacheSizes( pHeader, aSize );
+
+    uint64_t nOffset = (sizeof( CacheHeader ) + CACHE_ALIGN - 1) & ~(uint64_t)(CACHE_ALIGN - 1);
+    for( int iSection = 0; iSection < NUM_CACHE_SECTIONS; ++iSection )
+    {
+        pHeader->aSection[ iSection ] = nOffset;
+        nOffset = (nOffset + aSize[ iSection ] + CACHE_ALIGN - 1) & ~(uint64_t)(CACHE_ALIGN - 1);
+    }
+    pHeader->aSection[ NUM_CACHE_SECTIONS ] = nOffset;
+}
+
+// Checksum of the sections [iFirst,iEnd), including the zero padding between them
+// ======================================================================
+uint64_t CacheCheck( const CacheHeader *pHeader, const char *pView, int iFirst, int iEnd )
+{
+    return Checksum( pView + pHeader->aSection[ iFirst ], (size_t)(pHeader->aSection[ iEnd ] - pHeader->aSection[ iFirst ]) );
+}
+
+// Letter mask of the NUM_CHARS letters at pText, or 0 if any of them isn't a-z
+// ======================================================================
+inline int TextMask( const char *pText )
+{
+    int nHash = 0;
+    for( int iLetter = 0; iLetter < NUM_CHARS; ++iLetter )
+    {
+        unsigned int nLetter = (unsigned char) pText[iLetter] - 'a';
+        if (nLetter >= NUM_LETTERS)
+            return 0;
+        nHash |= 1 << nLetter;
+    }
+    return nHash;
+}
+
+// Checks that every word offset, mask and anagram chain of a cache stays in bounds, so a damaged file can't be indexed out of range.
+// Every word and anagram must spell its mask at its offset, and each chain must hold exactly gaAnagrams[] words, so a cycle is rejected.
+// ======================================================================
+bool CacheWordsValid( const CacheHeader *pHeader, const char *pView )
+{
+    const uint32_t *pWordOffset    = (const uint32_t*)(pView + pHeader->aSection[ CACHE_WORD_OFFSET    ]);
+    const int      *pHash          = (const int     *)(pView + pHeader->aSection[ CACHE_HASH           ]);
+    const int      *pAnagrams      = (const int     *)(pView + pHeader->aSection[ CACHE_ANAGRAMS       ]);
+    const int      *pAnagramHead   = (const int     *)(pView + pHeader->aSection[ CACHE_ANAGRAM_HEAD   ]);
+    const uint32_t *pAnagramOffset = (const uint32_t*)(pView + pHeader->aSection[ CACHE_ANAGRAM_OFFSET ]);
+    const int      *pAnagramNext   = (const int     *)(pView + pHeader->aSection[ CACHE_ANAGRAM_NEXT   ]);
+
+    int nWords    = pHeader->nUniqueWords;
+    int nAnagrams = pHeader->nAnagramWords;
+    if ((gnBufferSize < NUM_CHARS) || (pHeader->nWordsCheck != CacheCheck( pHeader, pView, CACHE_WORD_OFFSET, CACHE_NEIGHBOR_START )))
+        return false;
+
+    for( int iWord = 0; iWord < nAnagrams; ++iWord )
+        if ((pAnagramOffset[ iWord ] > gnBufferSize - NUM_CHARS) || (pAnagramNext[ iWord ] < -1) || (pAnagramNext[ iWord ] >= nAnagrams))
+            return false;
+
+    int nChained = 0;
+    for( int word0 = 0; word0 < nWords; ++word0 )
+    {
+        int nHash = pHash[ word0 ];
+        if ((nHash == 0) || (nHash & ~ALL_LETTERS) || (__builtin_popcount( nHash ) != NUM_CHARS)
+        ||  (pWordOffset[ word0 ] > gnBufferSize - NUM_CHARS) || (TextMask( gpBufferText + pWordOffset[ word0 ] ) != nHash)
+        ||  (pAnagrams[ word0 ] < 1) || (pAnagrams[ word0 ] > nAnagrams)
+        ||  (pAnagramHead[ word0 ] < 0) || (pAnagramHead[ word0 ] >= nAnagrams))
+            return false;
+
+        // Each chain is walked at most once per word it claims, and all of them at most once per anagram word
+        int nLinks = 0;
+        for( int iWord = pAnagramHead[ word0 ]; iWord >= 0; iWord = pAnagramNext[ iWord ] )
+            if ((++nLinks > pAnagrams[ word0 ]) || (++nChained > nAnagrams) || (TextMask( gpBufferText + pAnagramOffset[ iWord ] ) != nHash))
+                return false;
+        if (nLinks != pAnagrams[ word0 ])
+            return false;
+    }
+    return nChained == nAnagrams;
+}
+
+// Checks the CSR offsets of the cached graph.  Walking all of the edges costs more than Parse(), so they are only covered by the checksum.
+// ======================================================================
+bool CacheGraphValid( const CacheHeader *pHeader, const char *pView )
+{
+    const int *pStart = (const int*)(pView + pHeader->aSection[ CACHE_NEIGHBOR_START ]);
+    int        nWords = pHeader->nUniqueWords;
+
+    if ((pHeader->nMaxNeighbors < 0) || (pHeader->nMaxNeighbors >= MAX_NEIGHBORS) || (pStart[ 0 ] != 0)
+    ||  (pHeader->nGraphCheck != CacheCheck( pHeader, pView, CACHE_NEIGHBOR_START, NUM_CACHE_SECTIONS )))
+        return false;
+
+    for( int word0 = 0; word0 < nWords; ++word0 )
+    {
+        int nRow = pStart[ word0+1 ] - pStart[ word0 ];
+        if ((nRow < 0) || (nRow > pHeader->nMaxNeighbors) || (pStart[ word0+1 ] > pHeader->nNeighbors))
+            return false;
+    }
+    return pStart[ nWords ] == pHeader->nNeighbors;
+}
+
+// Maps the cache if it was built from the same dictionary.  The neighbors are used in place, the rest is copied.
+// The graph is only checked and used if bGraph, a cache without one is rejected then so the caller rebuilds it.
+// ======================================================================
+bool LoadCache( bool bGraph )
+{
+    struct stat info;
+    if ((stat( gpCacheName, &info ) != 0) || (info.st_size < (long long) sizeof( CacheHeader )))
+        return false;
+
+    size_t      nSize = (size_t) info.st_size;
+    const char *pView = (const char*) MapView( gpCacheName, nSize );
+    if (!pView)
+        return false;
+
+    CacheHeader header;
+    memcpy( &header, pView, sizeof( header ) );
+
+    CacheHeader layout = header;
+    CacheLayout( &layout );
+
+    if ((header.nMagic        != CACHE_MAGIC  )
+    ||  (header.nVersion      != CACHE_VERSION)
+    ||  (header.nChars        != NUM_CHARS    )
+    ||  (header.nTextSize     != gnBufferSize )
+    ||  (header.nUniqueWords  <  0) || (header.nUniqueWords > MAX_5_WORDS)
+    ||  (header.nAnagramWords <  header.nUniqueWords)
+    ||  (header.nNeighbors    <  0)
+    ||  ((header.nGraph != 0) && (header.nGraph != 1))
+    ||  (!header.nGraph && header.nNeighbors)
+    ||  (bGraph && !header.nGraph)
+    ||  (memcmp( header.aSection, layout.aSection, sizeof( header.aSection ) ) != 0)
+    ||  (header.aSection[ NUM_CACHE_SECTIONS ] > nSize)
+    ||  (header.nTextHash     != Checksum( gpBufferText, gnBufferSize ))
+    ||  !CacheWordsValid( &header, pView )
+    ||  (bGraph && !CacheGraphValid( &header, pView )))
+    {
+        UnmapView( pView, nSize );
+        return false;
+    }
+
+    const uint32_t *pWordOffset    = (const uint32_t*)(pView + header.aSection[ CACHE_WORD_OFFSET    ]);
+    const uint32_t *pAnagramOffset = (const uint32_t*)(pView + header.aSection[ CACHE_ANAGRAM_OFFSET ]);
+
+    gnUniqueWords  = header.nUniqueWords;
+    gnAnagramWords = header.nAnagramWords;
+
+    for( int word = 0; word < gnUniqueWords; ++word )
+        gaWords[ word ] = gpBufferText + pWordOffset[ word ];
+    memcpy( gaHash         , pView + header.aSection[ CACHE_HASH           ], sizeof( int ) *  gnUniqueWords      );
+    memcpy( gaAnagrams     , pView + header.aSection[ CACHE_ANAGRAMS       ], sizeof( int ) *  gnUniqueWords      );
+    memcpy( gaAnagramHead  , pView + header.aSection[ CACHE_ANAGRAM_HEAD   ], sizeof( int ) *  gnUniqueWords      );
+
+    gpAnagramWords = (const char**) malloc( sizeof( gpAnagramWords[0] ) * gnAnagramWords );
+    gpAnagramNext  = (int        *) malloc( sizeof( gpAnagramNext [0] ) * gnAnagramWords );
+    if (!gpAnagramWords || !gpAnagramNext)
+        exit( printf( "ERROR: Couldn't allocate memory for %d anagrams\n", gnAnagramWords ) );
+    for( int iWord = 0; iWord < gnAnagramWords; ++iWord )
+        gpAnagramWords[ iWord ] = gpBufferText + pAnagramOffset[ iWord ];
+    memcpy( gpAnagramNext, pView + header.aSection[ CACHE_ANAGRAM_NEXT ], sizeof( int ) * gnAnagramWords );
+
+    printf( "%6d unique %d letter words from cache %s\n", gnUniqueWords, NUM_CHARS, gpCacheName );
+    if (!bGraph) // everything was copied
+    {
+        UnmapView( pView, nSize );
+        return true;
+    }
+
+    // NOTE: Never unmapped since gpNeighbors point into the file, read-only
+    gnNeighbors    = header.nNeighbors;
+    memcpy( gaNeighborStart, pView + header.aSection[ CACHE_NEIGHBOR_START ], sizeof( int ) * (gnUniqueWords + 1) );
+    gpNeighbors    = (short*)(pView + header.aSection[ CACHE_NEIGHBORS     ]);
+    gpNeighborHash = (int  *)(pView + header.aSection[ CACHE_NEIGHBOR_HASH ]);
+    gbGraphMapped  = true;
+    gbGraphValid   = true;
+
+    printf( "%6d neighbors, max %d per word\n", gnNeighbors, header.nMaxNeighbors );
+    return true;
+}
+
+// Saves the words, and if bGraph builds the graph in file order and saves it too.  Failing to write the cache isn't fatal.
+// ======================================================================
+void SaveCache( bool bGraph )
+{
+    if (bGraph)
+        Prepare();
+
+    CacheHeader header;
+    memset( &header, 0, sizeof( header ) );
+    header.nVersion      = CACHE_VERSION;
+    header.nTextHash     = Checksum( gpBufferText, gnBufferSize );
+    header.nTextSize     = gnBufferSize;
+    header.nChars        = NUM_CHARS;
+    header.nUniqueWords  = gnUniqueWords;
+    header.nAnagramWords = gnAnagramWords;
+    header.nNeighbors    = bGraph ? gnNeighbors : 0;
+    header.nGraph        = bGraph;
+    for( int word = 0; bGraph && (word < gnUniqueWords); ++word )
+        if (header.nMaxNeighbors < gaNeighborStart[ word+1 ] - gaNeighborStart[ word ])
+            header.nMaxNeighbors = gaNeighborStart[ word+1 ] - gaNeighborStart[ word ];
+    CacheLayout( &header );
+
+    uint32_t *pWordOffset    = (uint32_t*) malloc( sizeof( uint32_t ) * gnUniqueWords  );
+    uint32_t *pAnagramOffset = (uint32_t*) malloc( sizeof( uint32_t ) * gnAnagramWords );
+    if (!pWordOffset || !pAnagramOffset)
+        exit( printf( "ERROR: Couldn't allocate memory for %d anagrams\n", gnAnagramWords ) );
+    for( int word = 0; word < gnUniqueWords; ++word )
+        pWordOffset[ word ] = (uint32_t)(gaWords[ word ] - gpBufferText);
+    for( int iWord = 0; iWord < gnAnagramWords; ++iWord )
+        pAnagramOffset[ iWord ] = (uint32_t)(gpAnagramWords[ iWord ] - gpBufferText);
+
+    const void *aData[ NUM_CACHE_SECTIONS ] =
+    {
+        pWordOffset,
+        gaHash,
+        gaAnagrams,
+        gaAnagramHead,
+        pAnagramOffset,
+        gpAnagramNext,
+        gaNeighborStart,
+        gpNeighbors,
+        gpNeighborHash,
+    };
+
+    size_t aSize[ NUM_CACHE_SECTIONS ];
+    CacheSizes( &header, aSize );
+
+    // The checksums cover the padding too, so lay the whole file out in memory first
+    size_t nSize  = (size_t) header.aSection[ NUM_CACHE_SECTIONS ];
+    char  *pImage = (char*) calloc( nSize, 1 );
+    if (!pImage)
+        exit( printf( "ERROR: Couldn't allocate memory for %d KB cache\n", (int)(nSize >> 10) ) );
+    for( int iSection = 0; iSection < NUM_CACHE_SECTIONS; ++iSection )
+        if (aSize[ iSection ])
+            memcpy( pImage + header.aSection[ iSection ], aData[ iSection ], aSize[ iSection ] );
+    header.nWordsCheck = CacheCheck( &header, pImage, CACHE_WORD_OFFSET   , CACHE_NEIGHBOR_START );
+    header.nGraphCheck = CacheCheck( &header, pImage, CACHE_NEIGHBOR_START, NUM_CACHE_SECTIONS   );
+
+    free( pWordOffset    );
+    free( pAnagramOffset );
+
+    // Other runs may have the cache mapped: truncating it in place would crash them, so write a new file and swap it in
+    char aTempName[ 1024 ];
+    snprintf( aTempName, sizeof( aTempName ), "%s.tmp", gpCacheName );
+
+    FILE *file = fopen( aTempName, "wb" );
+    if (!file)
+    {
+        printf( "WARNING: Couldn't write cache file: %s\n", gpCacheName );
+        free( pImage );
+        return;
+    }
+
+    // The magic is written last so a partial file is never loaded
+    memcpy( pImage, &header, sizeof( header ) );
+    bool bOK = (fwrite( pImage, 1, nSize, file ) == nSize);
+
+    header.nMagic = CACHE_MAGIC;
+    bOK = bOK && (fseek( file, 0, SEEK_SET ) == 0) && (fwrite( &header, sizeof( header ), 1, file ) == 1);
+    bOK = (fclose( file ) == 0) && bOK;
+#ifdef _WIN32
+    bOK = bOK && MoveFileExA( aTempName, gpCacheName, MOVEFILE_REPLACE_EXISTING );
+#else
+    bOK = bOK && (rename( aTempName, gpCacheName ) == 0);
+#endif
+    if (!bOK)
+        remove( aTempName );
+
+    if (bOK)
+        printf( "%6d KB cache saved to %s%s\n", (int)(nSize >> 10), gpCacheName, bGraph ? "" : ", without the graph" );
+    else
+        printf( "WARNING: Couldn't write cache file: %s\n", gpCacheName );
+
+    free( pImage );
+}
+
+// Every word of a 5-clique has at least 4 neighbors that are also in the clique.
+// Iteratively removes words with fewer than 4 remaining neighbors (k-core with k = 4), then compacts the word list.
+// ======================================================================
+void Prune()
+{
+    const int K = NUM_WORDS - 1;
+
+    Prepare();
+
+    static bool  aRemoved[ MAX_5_WORDS ];
+    static int   aDegree [ MAX_5_WORDS ];
+    memset( aRemoved, 0, sizeof( aRemoved ) );
+
+    int nRounds  = 0;
+    int nRemoved = 0;
+    for( bool bRemoved = true; bRemoved; ++nRounds )
+    {
+        memset( aDegree, 0, sizeof( aDegree ) );
+        for( int word0 = 0; word0 < gnUniqueWords; ++word0 )
+        {
+            if (aRemoved[ word0 ])
+                continue;
+
+            for( int iOffset1 = gaNeighborStart[ word0 ]; iOffset1 < gaNeighborStart[ word0+1 ]; ++iOffset1 )
+            {
+                int word1 = gpNeighbors[ iOffset1 ];
+                if (!aRemoved[ word1 ])
+                {
+                    aDegree[ word0 ]++; // the DAG only stores forward edges so count both ends
+                    aDegree[ word1 ]++;
+                }
+            }
+        }
+
+        bRemoved = false;
+        for( int word = 0; word < gnUniqueWords; ++word )
+            if (!aRemoved[ word ] && (aDegree[ word ] < K))
+            {
+                aRemoved[ word ] = true;
+                bRemoved         = true;
+                nRemoved++;
+            }
+    }
+
+    if (!nRemoved) // keep the graph, relabeling would force Prepare() to rebuild it
+    {
+        printf( "%6d words pruned in %d rounds\n", nRemoved, nRounds );
+        return;
+    }
+
+    short aKeep[ MAX_5_WORDS ];
+    int   nKeep = 0;
+    for( int word = 0; word < gnUniqueWords; ++word )
+        if (!aRemoved[ word ])
+            aKeep[ nKeep++ ] = (short) word;
+
+    Relabel( aKeep, nKeep );
+
+    printf( "%6d words pruned in %d rounds\n", nRemoved, nRounds );
+}
+
+// Number of compatible words in both directions; a word is never compatible with itself
+// ======================================================================
+void Degrees( int *pDegree )
+{
+#pragma omp parallel for
+    for( int word0 = 0; word0 < gnUniqueWords; ++word0 )
+    {
+        int nDegree = 0;
+        for( int word1 = 0; word1 < gnUniqueWords; ++word1 )
+            nDegree += (gaHash[ word0 ] & gaHash[ word1 ]) == 0;
+        pDegree[ word0 ] = nDegree;
+    }
+}
+
+// Lowest degree first.  The DAG points from low to high degree so no word has more forward neighbors than O(sqrt(edges))
+// ======================================================================
+void OrderDegree()
+{
+    static int   aDegree[ MAX_5_WORDS ];
+           short aOrder [ MAX_5_WORDS ];
+
+    Degrees( aDegree );
+    for( int word = 0; word < gnUniqueWords; ++word )
+        aOrder[ word ] = (short) word;
+
+    std::stable_sort( aOrder, aOrder + gnUniqueWords, []( short a, short b ) { return aDegree[ a ] < aDegree[ b ]; } );
+    Relabel( aOrder, gnUniqueWords );
+}
+
+// Repeatedly removes the word with the fewest remaining neighbors; words are numbered in removal order.
+// Each word's forward neighbors are the ones still remaining when it was removed, so no word has more forward neighbors than the degeneracy.
+// This also makes the work per word0 more uniform.
+// ======================================================================
+void OrderDegeneracy()
+{
+    static int   aDegree [ MAX_5_WORDS ];
+    static bool  aRemoved[ MAX_5_WORDS ];
+           short aOrder  [ MAX_5_WORDS ];
+
+    Degrees( aDegree );
+    memset( aRemoved, 0, sizeof( aRemoved ) );
+
+    int nDegeneracy = 0;
+    int wordMin     = 0;
+    for( int iOrder = 0; iOrder < gnUniqueWords; ++iOrder )
+    {
+        if (iOrder == 0)
+            for( int word = 1; word < gnUniqueWords; ++word )
+                if (aDegree[ word ] < aDegree[ wordMin ])
+                    wordMin = word;
+
+        int word0 = wordMin;
+        aOrder  [ iOrder ] = (short) word0;
+        aRemoved[ word0  ] = true;
+        if (nDegeneracy < aDegree[ word0 ])
+            nDegeneracy = aDegree[ word0 ];
+
+        // Remove word0 and find the next word with the fewest remaining neighbors in the same pass
+        wordMin = -1;
+        for( int word1 = 0; word1 < gnUniqueWords; ++word1 )
+        {
+            if (aRemoved[ word1 ])
+                continue;
+
+            aDegree[ word1 ] -= (gaHash[ word0 ] & gaHash[ word1 ]) == 0;
+            if ((wordMin < 0) || (aDegree[ word1 ] < aDegree[ wordMin ]))
+                wordMin = word1;
+        }
+    }
+
+    Relabel( aOrder, gnUniqueWords );
+    printf( "%6d degeneracy\n", nDegeneracy );
+}
+
+// Sorting by mask groups words that share their highest letters (z, y, x, w, ... mostly rare ones),
+// and words that share letters are never neighbors, so each neighbor list becomes a few dense runs
+// ======================================================================
+void OrderMask()
+{
+    short aOrder[ MAX_5_WORDS ];
+    for( int word = 0; word < gnUniqueWords; ++word )
+        aOrder[ word ] = (short) word;
+
+    std::sort( aOrder, aOrder + gnUniqueWords, []( short a, short b ) { return gaHash[ a ] < gaHash[ b ]; } );
+    Relabel( aOrder, gnUniqueWords );
+}
+
+// Reverse Cuthill-McKee: breadth first from the lowest degree word, visiting neighbors lowest degree first, then reversed.
+// Reduces the bandwidth of the graph so the neighbors of a word have nearby numbers.
+// ======================================================================
+void OrderRcm()
+{
+    static int   aDegree [ MAX_5_WORDS ];
+    static bool  aVisited[ MAX_5_WORDS ];
+           short aOrder  [ MAX_5_WORDS ];
+
+    Degrees( aDegree );
+    memset( aVisited, 0, sizeof( aVisited ) );
+
+    int nOrder = 0;
+    int iHead  = 0;
+    while (nOrder < gnUniqueWords) // once per connected component
+    {
+        int wordStart = -1;
+        for( int word = 0; word < gnUniqueWords; ++word )
+            if (!aVisited[ word ] && ((wordStart < 0) || (aDegree[ word ] < aDegree[ wordStart ])))
+                wordStart = word;
+
+        aVisited[ wordStart ] = true;
+        aOrder  [ nOrder++  ] = (short) wordStart;
+
+        for( ; iHead < nOrder; ++iHead )
+        {
+            int word0  = aOrder[ iHead ];
+            int iFirst = nOrder;
+
+            for( int word1 = 0; word1 < gnUniqueWords; ++word1 )
+                if (!aVisited[ word1 ] && ((gaHash[ word0 ] & gaHash[ word1 ]) == 0))
+                {
+                    aVisited[ word1    ] = true;
+                    aOrder  [ nOrder++ ] = (short) word1;
+                }
+
+            std::stable_sort( aOrder + iFirst, aOrder + nOrder, []( short a, short b ) { return aDegree[ a ] < aDegree[ b ]; } );
+        }
+    }
+
+    std::reverse( aOrder, aOrder + gnUniqueWords );
+    Relabel( aOrder, gnUniqueWords );
+}
+
+// Returns the first offset in [iOffset, nEnd) whose mask doesn't share any letters with nHash, or nEnd
+// ======================================================================
+inline int NextDisjoint( const int *pHash, int iOffset, int nEnd, int nHash )
+{
+    while ((iOffset < nEnd) && (pHash[ iOffset ] & nHash))
+        ++iOffset;
+    return iOffset;
+}
+
+// Calls Visit( word, hash ) for every neighbor in [iOffset, nEnd) of the DAG that doesn't share any letters with nHash.
+// Almost none do, so long rows are filtered 8 or 16 at a time with gpFilterRow, and short rows are cheaper to scan,
+// as is every row with the scalar kernels: FilterRowScalar() copies every neighbor where the scan only tests it.
+// NOTE: The pointers are copied to locals, else they are reloaded from memory for every neighbor since Visit may call anything.
+// ======================================================================
+template< typename VisitFunc >
+inline void ForDisjoint( int iOffset, int nEnd, int nHash, VisitFunc Visit )
+{
+    const short *pWords = gpNeighbors;
+    const int   *pHash  = gpNeighborHash;
+
+    if ((gnSimd == SIMD_SCALAR) || (nEnd - iOffset < MIN_FILTER_ROW))
+    {
+        for (iOffset = NextDisjoint( pHash, iOffset, nEnd, nHash ); iOffset < nEnd; iOffset = NextDisjoint( pHash, iOffset+1, nEnd, nHash ))
+            Visit( pWords[ iOffset ], pHash[ iOffset ] );
+        return;
+    }
+
+    short aWords[ FILTER_ROW_CHUNK+16 ]; // SIMD stores may write up to 16 entries past the end
+    for (; iOffset < nEnd; iOffset += FILTER_ROW_CHUNK)
+    {
+        int nWords = gpFilterRow( pWords + iOffset, pHash + iOffset, std::min( FILTER_ROW_CHUNK, nEnd - iOffset ), nHash, aWords );
+        for (int iWord = 0; iWord < nWords; ++iWord)
+            Visit( aWords[ iWord ], gaHash[ aWords[ iWord ] ] );
+    }
+}
+
+// Levels 2, 3, 4 of Search3() for one (word0, word1) pair.  Levels 3 and 4 scan the longest rows, see ForDisjoint()
+// ======================================================================
+inline void Search3Pair( int iThread, int word0, int word1, int nHash1 )
+{
+    const bool bCount   = CountLeaves();
+          int  nOffset2 = gaNeighborStart[ word1+1 ];
+
+    for (int iOffset2 = gaNeighborStart[ word1 ]; iOffset2 < nOffset2; ++iOffset2)
+    {
+        int hash2 = nHash1 & gpNeighborHash[ iOffset2 ];
+        if( hash2 )
+            continue;
+
+        int word2  = gpNeighbors[ iOffset2 ];
+        int nHash2 = nHash1 | gpNeighborHash[ iOffset2 ];
+
+        ForDisjoint( gaNeighborStart[ word2 ], gaNeighborStart[ word2+1 ], nHash2, [&]( int word3, int hash3 )
+        {
+            int nHash3   = nHash2 | hash3;
+            int iOffset4 = gaNeighborStart[ word3 ];
+            int nLeaf    = gaNeighborStart[ word3+1 ] - iOffset4;
+
+            // -count without -anagrams: almost every leaf has no solutions, so first count the survivors 8 or 16 at a time
+            if (bCount)
+            {
+                if (gpCount( gpNeighborHash + iOffset4, nLeaf, nHash3 ))
+                    CountLeafHash( iThread, gpNeighborHash + iOffset4, nLeaf, nHash3 );
+                return;
+            }
+
+            ForDisjoint( iOffset4, iOffset4 + nLeaf, nHash3, [&]( int word4, int )
+            {
+                Emit( iThread, word0, word1, word2, word3, word4 );
+            } );
+        } );
+    }
+}
+
+// ======================================================================
+void Search3()
+{
+#pragma omp parallel for
+    for (int word0 = 0; word0 < gnUniqueWords; ++word0) // Every word effectively has a neighbor
+    {
+        int iThread = omp_get_thread_num();
+
+        int nHash0   = 0 | gaHash[ word0 ];       // "previous" hash is zero
+        int nOffset1 = gaNeighborStart[ word0+1 ];
+
+        for (int iOffset1 = gaNeighborStart[ word0 ]; iOffset1 < nOffset1; ++iOffset1)
+        {
+            int hash1 = gpNeighborHash[ iOffset1 ] & nHash0;
+            if( hash1 )
+                continue;
+
+            Search3Pair( iThread, word0, gpNeighbors[ iOffset1 ], nHash0 | gpNeighborHash[ iOffset1 ] );
+        }
+    }
+}
+
+// Same search as Search3() but each (word0, word1) pair, i.e. each edge of the DAG, is its own work item.
+// Forward neighbors make the cost per word0 very triangular; with a static schedule the first threads get almost all of the work.
+// Instead idle threads keep grabbing the next pair from the shared queue. Pairs are numbered heaviest first (low word0, low word1).
+// NOTE: MSVC's /openmp is OpenMP 2.0 which has no tasks, hence dynamic scheduling.
+// ======================================================================
+void SearchPairs()
+{
+#pragma omp parallel for schedule(dynamic)
+    for (int iPair = 0; iPair < gnNeighbors; ++iPair)
+    {
+        int iThread = omp_get_thread_num();
+
+        // Binary search for the last word0 whose first edge is <= iPair
+        int word0 = 0;
+        int iLast = gnUniqueWords;
+        while (iLast - word0 > 1)
+        {
+            int iMid = (word0 + iLast) / 2;
+            if (gaNeighborStart[ iMid ] <= iPair)
+                word0 = iMid;
+            else
+                iLast = iMid;
+        }
+
+        Search3Pair( iThread, word0, gpNeighbors[ iPair ], gaHash[ word0 ] | gpNeighborHash[ iPair ] );
+    }
+}
+
+// Returns the slot with this mask, or an empty slot
+// ======================================================================
+inline int JoinFind( int nMask )
+{
+    int iSlot = HashSlot( nMask, gnJoinShift );
+    while (gpJoinKeys[ iSlot ] && (gpJoinKeys[ iSlot ] != nMask))
+        iSlot = (iSlot + 1) & (gnJoinSlots - 1);
+    return iSlot;
+}
+
+// Materializes every pair of compatible words as its 10 letter mask, and indexes them by mask
+// ======================================================================
+void PrepareJoin()
+{
+    Prepare();
+
+    gnJoinPairs = gnNeighbors;
+
+    gpJoinPairs = (uint64_t*) malloc( sizeof( uint64_t ) * (gnJoinPairs + 1) );
+    if (!gpJoinPairs)
+        exit( printf( "ERROR: Couldn't allocate memory for %d pairs\n", gnJoinPairs ) );
+
+#pragma omp parallel for
+    for( int word0 = 0; word0 < gnUniqueWords; ++word0 )
+    {
+        int nOffset1 = gaNeighborStart[ word0+1 ];
+
+        for( int iOffset1 = gaNeighborStart[ word0 ]; iOffset1 < nOffset1; ++iOffset1 )
+        {
+            int word1 = gpNeighbors[ iOffset1 ];
+            gpJoinPairs[ iOffset1 ] = ((uint64_t)(gaHash[ word0 ] | gpNeighborHash[ iOffset1 ]) << 32) | (word0 << 16) | word1;
+        }
+    }
+    std::sort( gpJoinPairs, gpJoinPairs + gnJoinPairs );
+
+    gnJoinMasks = 0;
+    for( int iPair = 0; iPair < gnJoinPairs; ++iPair )
+        gnJoinMasks += (iPair == 0) || ((gpJoinPairs[ iPair ] >> 32) != (gpJoinPairs[ iPair-1 ] >> 32));
+
+    for( gnJoinShift = 32, gnJoinSlots = 1; gnJoinSlots < 2*gnJoinMasks; gnJoinSlots *= 2 )
+        gnJoinShift--;
+
+    gpJoinKeys  = (int*) calloc( gnJoinSlots, sizeof( int ) );
+    gpJoinStart = (int*) malloc( gnJoinSlots * sizeof( int ) );
+    gpJoinEnd   = (int*) malloc( gnJoinSlots * sizeof( int ) );
+    if (!gpJoinKeys || !gpJoinStart || !gpJoinEnd)
+        exit( printf( "ERROR: Couldn't allocate memory for %d masks\n", gnJoinMasks ) );
+
+    for( int iPair = 0; iPair < gnJoinPairs; )
+    {
+        int nMask = (int)(gpJoinPairs[ iPair ] >> 32);
+        int iSlot = JoinFind( nMask );
+
+        gpJoinKeys [ iSlot ] = nMask;
+        gpJoinStart[ iSlot ] = iPair;
+        while ((iPair < gnJoinPairs) && ((int)(gpJoinPairs[ iPair ] >> 32) == nMask))
+            iPair++;
+        gpJoinEnd  [ iSlot ] = iPair;
+    }
+
+    printf( "%6d unique 10 letter masks\n", gnJoinMasks );
+}
+
+// Enumerates 3-word partial cliques, then joins them with a precomputed pair.
+// The pair must cover the 11 remaining letters except one, so there are only 11 masks to look up instead of walking levels 3 and 4.
+// ======================================================================
+void SearchJoin()
+{
+#pragma omp parallel for schedule(dynamic)
+    for (int word0 = 0; word0 < gnUniqueWords; ++word0)
+    {
+        int iThread = omp_get_thread_num();
+
+        int nHash0   = gaHash[ word0 ];
+        int nOffset1 = gaNeighborStart[ word0+1 ];
+
+        for (int iOffset1 = gaNeighborStart[ word0 ]; iOffset1 < nOffset1; ++iOffset1)
+        {
+            int word1    = gpNeighbors[ iOffset1 ];
+            int nHash1   = nHash0 | gpNeighborHash[ iOffset1 ];
+            int nOffset2 = gaNeighborStart[ word1+1 ];
+
+            for (int iOffset2 = gaNeighborStart[ word1 ]; iOffset2 < nOffset2; ++iOffset2)
+            {
+                if (nHash1 & gpNeighborHash[ iOffset2 ])
+                    continue;
+
+                int word2 = gpNeighbors[ iOffset2 ];
+                int nFree = ~(nHash1 | gpNeighborHash[ iOffset2 ]) & ALL_LETTERS;
+
+                for( int nLetters = nFree; nLetters; nLetters &= nLetters - 1 ) // each of the 11 letters can be the missing one
+                {
+                    int nMask = nFree & ~(nLetters & -nLetters);
+                    int iSlot = JoinFind( nMask );
+                    if (!gpJoinKeys[ iSlot ])
+                        continue;
+
+                    // The missing letter is known, and the pairs after word2 are a binary search away
+                    if (CountLeaves())
+                    {
+                        uint64_t nFirst = ((uint64_t) nMask << 32) | ((uint64_t) word2 << 16) | 0xFFFF;
+                        const uint64_t *pFirst = std::upper_bound( gpJoinPairs + gpJoinStart[ iSlot ], gpJoinPairs + gpJoinEnd[ iSlot ], nFirst );
+                        AddLeaves( iThread, __builtin_ctz( nLetters ), (int)(gpJoinPairs + gpJoinEnd[ iSlot ] - pFirst) );
+                        continue;
+                    }
+
+                    // Pairs are sorted by word0; only pairs after word2 keep the clique in ascending order
+                    for( int iPair = gpJoinEnd[ iSlot ] - 1; iPair >= gpJoinStart[ iSlot ]; --iPair )
+                    {
+                        int word3 = (int)(gpJoinPairs[ iPair ] >> 16) & 0xFFFF;
+                        if (word3 <= word2)
+                            break;
+
+                        Emit( iThread, word0, word1, word2, word3, (int)(gpJoinPairs[ iPair ] & 0xFFFF) );
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Per-thread scratch of NUM_WORDS-1 levels that may each hold every word, SIMD stores may write up to 16 entries past the end.
+// Only the engines that filter word lists need it, so it is allocated by their Prepare and freed after their Search.
+// ======================================================================
+short* AllocThreadRows()
+{
+    size_t nRows  = (size_t) omp_get_max_threads() * (NUM_WORDS-1);
+    short *pRows  = (short*) malloc( sizeof( short ) * nRows * (gnUniqueWords + 16) );
+    if (!pRows)
+        exit( printf( "ERROR: Couldn't allocate memory for %d words per thread\n", gnUniqueWords ) );
+    return pRows;
+}
+
+// ======================================================================
+inline short* ThreadRows( short *pRows, int iThread, int iLevel )
+{
+    return pRows + ((size_t) iThread * (NUM_WORDS-1) + iLevel) * (gnUniqueWords + 16);
+}
+
+// ======================================================================
+void PrepareMemo()
+{
+    Prepare();
+
+    // Sized by the word count, but there are never more masks than ways to pick the letters of 3 words
+    int64_t nLetterMasks = 1;
+    for( int iLetter = 0; iLetter < NUM_CHARS * (NUM_WORDS-2); ++iLetter )
+        nLetterMasks = nLetterMasks * (NUM_LETTERS - iLetter) / (iLetter + 1);
+    int64_t nMasks = std::min( (int64_t) gnUniqueWords * MEMO_PER_WORD, nLetterMasks );
+
+    // At most 3/4 full, and never less than MAX_THREADS empty slots since threads may all claim one past gnMemoMax
+    for( gnMemoSlots = 1 << 16, gnMemoShift = 32 - 16; (int64_t) gnMemoSlots / 4 * 3 < nMasks; gnMemoSlots *= 2, gnMemoShift-- )
+        ;
+    gnMemoMax = gnMemoSlots / 4 * 3;
+
+    gpMemoKeys   = (std::atomic<int>             *) calloc( gnMemoSlots, sizeof( gpMemoKeys  [0] ) );
+    gpMemoValues = (std::atomic<const MemoPairs*>*) calloc( gnMemoSlots, sizeof( gpMemoValues[0] ) );
+    if (!gpMemoKeys || !gpMemoValues)
+        exit( printf( "ERROR: Couldn't allocate memory for %d memoized masks\n", gnMemoSlots ) );
+
+    for( int word = 0; word < gnUniqueWords; ++word )
+        gaMemoAll[ word ] = (short) word;
+
+    gpMemoWords = AllocThreadRows();
+}
+
+// Returns the completions of nMask, or NULL if this thread claimed the empty slot and must fill it in.
+// If the table is full *pSlot is -1 instead: the caller computes the completions, uses them, and frees them.
+// ======================================================================
+inline const MemoPairs* MemoFind( int nMask, int *pSlot )
+{
+    int iSlot = HashSlot( nMask, gnMemoShift );
+    for(;;)
+    {
+        int nKey = gpMemoKeys[ iSlot ].load( std::memory_order_acquire );
+        if (nKey == nMask)
+        {
+            const MemoPairs *pPairs;
+            while (!(pPairs = gpMemoValues[ iSlot ].load( std::memory_order_acquire ))) // another thread is filling it in
+#if USE_SIMD
+                _mm_pause();                            // don't starve the sibling hyperthread
+#else
+                std::this_thread::yield();
+#endif
+            return pPairs;
+        }
+
+        if (!nKey)
+        {
+            if (gnMemoMasks.load( std::memory_order_relaxed ) >= gnMemoMax)
+            {
+                *pSlot = -1;
+                return NULL;
+            }
+
+            if (!gpMemoKeys[ iSlot ].compare_exchange_strong( nKey, nMask ))
+                continue; // lost the race, check what the winner stored
+
+            gnMemoMasks++;
+            *pSlot = iSlot;
+            return NULL;
+        }
+
+        iSlot = (iSlot + 1) & (gnMemoSlots - 1);
+    }
+}
+
+// Every pair of disjoint words from pCand3, which are already disjoint from the 3 words
+// ======================================================================
+const MemoPairs* MemoPairsOf( const short *pCand3, int nCand3, short *pCand4 )
+{
+    int nMaxPairs = nCand3 * (nCand3 - 1) / 2;
+    if (!nMaxPairs)
+        return &gMemoNone;
+
+    MemoPairs *pMemo = (MemoPairs*) malloc( sizeof( MemoPairs ) + nMaxPairs * 2 * sizeof( short ) );
+    if (!pMemo)
+        exit( printf( "ERROR: Couldn't allocate memory for %d pairs\n", nMaxPairs ) );
+    pMemo->pPairs = (short*)(pMemo + 1);
+    pMemo->nPairs = 0;
+
+    for( int iCand3 = 0; iCand3 < nCand3; ++iCand3 )
+    {
+        int word3  = pCand3[ iCand3 ];
+        int nCand4 = gpFilter( pCand3 + iCand3 + 1, nCand3 - iCand3 - 1, gaHash[ word3 ], pCand4 );
+
+        for( int iCand4 = 0; iCand4 < nCand4; ++iCand4 )
+        {
+            pMemo->pPairs[ 2*pMemo->nPairs + 0 ] = (short) word3;
+            pMemo->pPairs[ 2*pMemo->nPairs + 1 ] = pCand4[ iCand4 ];
+            pMemo->nPairs++;
+        }
+    }
+
+    if (!pMemo->nPairs)
+    {
+        free( pMemo );
+        return &gMemoNone;
+    }
+
+    pMemo = (MemoPairs*) realloc( pMemo, sizeof( MemoPairs ) + pMemo->nPairs * 2 * sizeof( short ) ); // shrinking never fails
+    pMemo->pPairs = (short*)(pMemo + 1);
+    return pMemo;
+}
+
+// Levels 0, 1, 2 of Search3(), then levels 3 and 4 come from a table of completions keyed by the 15 letters used so far.
+// On average 75 prefixes share the same letters, so the search tree collapses into a DAG over letter masks.
+// The completions include words before word2, since other prefixes with the same letters may have a smaller word2.
+// ======================================================================
+void SearchMemo()
+{
+#pragma omp parallel for schedule(dynamic)
+    for (int word0 = 0; word0 < gnUniqueWords; ++word0)
+    {
+        int    iThread = omp_get_thread_num();
+        short *pAll1   = ThreadRows( gpMemoWords, iThread, 0 );
+        short *pAll2   = ThreadRows( gpMemoWords, iThread, 1 );
+        short *pAll3   = ThreadRows( gpMemoWords, iThread, 2 );
+        short *pAll4   = ThreadRows( gpMemoWords, iThread, 3 );
+        int    nAll1   = -1; // only filled in on the first miss
+        int    nAll2   = -1;
+
+        int nHash0   = gaHash[ word0 ];
+        int nOffset1 = gaNeighborStart[ word0+1 ];
+
+        for (int iOffset1 = gaNeighborStart[ word0 ]; iOffset1 < nOffset1; ++iOffset1, nAll2 = -1)
+        {
+            int word1    = gpNeighbors[ iOffset1 ];
+            int nHash1   = nHash0 | gpNeighborHash[ iOffset1 ];
+            int nOffset2 = gaNeighborStart[ word1+1 ];
+
+            for (int iOffset2 = gaNeighborStart[ word1 ]; iOffset2 < nOffset2; ++iOffset2)
+            {
+                if (nHash1 & gpNeighborHash[ iOffset2 ])
+                    continue;
+
+                int word2  = gpNeighbors[ iOffset2 ];
+                int iSlot  = 0;
+
+                const MemoPairs *pPairs = MemoFind( nHash1 | gpNeighborHash[ iOffset2 ], &iSlot );
+                if (!pPairs)
+                {
+                    if (nAll1 < 0)
+                        nAll1 = gpFilter( gaMemoAll, gnUniqueWords, nHash0, pAll1 );
+                    if (nAll2 < 0)
+                        nAll2 = gpFilter( pAll1, nAll1, gaHash[ word1 ], pAll2 );
+
+                    int nAll3 = gpFilter( pAll2, nAll2, gaHash[ word2 ], pAll3 );
+                    pPairs = MemoPairsOf( pAll3, nAll3, pAll4 );
+                    if (iSlot >= 0)
+                        gpMemoValues[ iSlot ].store( pPairs, std::memory_order_release );
+                    else
+                        gnMemoSkips++;
+                }
+
+                // Pairs are sorted by word3; only pairs after word2 keep the clique in ascending order
+                for (int iPair = pPairs->nPairs - 1; iPair >= 0; --iPair)
+                {
+                    int word3 = pPairs->pPairs[ 2*iPair + 0 ];
+                    if (word3 <= word2)
+                        break;
+
+                    if (CountLeaves())
+                    {
+                        int nUsed = nHash1 | gpNeighborHash[ iOffset2 ] | gaHash[ word3 ] | gaHash[ pPairs->pPairs[ 2*iPair + 1 ] ];
+                        AddLeaves( iThread, __builtin_ctz( ~nUsed & ALL_LETTERS ), 1 );
+                        continue;
+                    }
+
+                    Emit( iThread, word0, word1, word2, word3, pPairs->pPairs[ 2*iPair + 1 ] );
+                }
+
+                if ((iSlot < 0) && (pPairs != &gMemoNone)) // not in the table, nothing else will read it
+                    free( (void*) pPairs );
+            }
+        }
+    }
+
+    free( gpMemoWords );
+    gpMemoWords = NULL;
+
+    printf( "%6d unique %d letter masks memoized in %d slots\n", gnMemoMasks.load(), NUM_CHARS * (NUM_WORDS-2), gnMemoSlots );
+    if (gnMemoSkips.load())
+        printf( "%6d completions computed without memoizing them, the table was full\n", gnMemoSkips.load() );
+}
+
+// ======================================================================
+void PrepareFilter()
+{
+    Prepare();
+    gpCandidates = AllocThreadRows();
+}
+
+// Each level only tests the previous level's survivors against the newly chosen word.
+// Since neighbor lists are sorted, candidates after the chosen word are the only ones that can follow it.
+// ======================================================================
+void SearchFilter()
+{
+#pragma omp parallel for schedule(dynamic)
+    for (int word0 = 0; word0 < gnUniqueWords; ++word0)
+    {
+        int    iThread  = omp_get_thread_num();
+        short *pCand0   = gpNeighbors + gaNeighborStart[ word0 ];
+        int    nCand0   = gaNeighborStart[ word0+1 ] - gaNeighborStart[ word0 ];
+        short *pCand1   = ThreadRows( gpCandidates, iThread, 0 );
+        short *pCand2   = ThreadRows( gpCandidates, iThread, 1 );
+        short *pCand3   = ThreadRows( gpCandidates, iThread, 2 );
+
+        for (int iCand0 = 0; iCand0 < nCand0; ++iCand0)
+        {
+            int word1  = pCand0[ iCand0 ];
+            int nCand1 = gpFilter( pCand0 + iCand0 + 1, nCand0 - iCand0 - 1, gaHash[ word1 ], pCand1 );
+
+            for (int iCand1 = 0; iCand1 < nCand1; ++iCand1)
+            {
+                int word2  = pCand1[ iCand1 ];
+                int nCand2 = gpFilter( pCand1 + iCand1 + 1, nCand1 - iCand1 - 1, gaHash[ word2 ], pCand2 );
+
+                for (int iCand2 = 0; iCand2 < nCand2; ++iCand2)
+                {
+                    int word3  = pCand2[ iCand2 ];
+                    int nCand3 = gpFilter( pCand2 + iCand2 + 1, nCand2 - iCand2 - 1, gaHash[ word3 ], pCand3 );
+
+                    if (CountLeaves())
+                    {
+                        CountLeafWords( iThread, pCand3, nCand3, gaHash[ word0 ] | gaHash[ word1 ] | gaHash[ word2 ] | gaHash[ word3 ] );
+                        continue;
+                    }
+
+                    for (int iCand3 = 0; iCand3 < nCand3; ++iCand3) // every survivor completes a clique
+                    {
+                        Emit( iThread, word0, word1, word2, word3, pCand3[ iCand3 ] );
+                    }
+                }
+            }
+        }
+    }
+
+    free( gpCandidates );
+    gpCandidates = NULL;
+}
+
+// Compatible words are the complement of the union of the per-letter bitsets of the word's 5 letters.
+// The bitsets are sized by the actual word count, and freed after SearchBitset()
+// ======================================================================
+void PrepareBitset()
+{
+    gnBitsetWords = (gnUniqueWords + 63) / 64;
+
+    size_t nLevels = (size_t) omp_get_max_threads() * (NUM_WORDS-2);
+    gpBitsets      = (uint64_t*) malloc( sizeof( uint64_t ) * gnBitsetWords * gnUniqueWords );
+    gpBitsetLevel  = (uint64_t*) malloc( sizeof( uint64_t ) * gnBitsetWords * nLevels       );
+    if (!gpBitsets || !gpBitsetLevel)
+        exit( printf( "ERROR: Couldn't allocate memory for %d bitsets\n", gnUniqueWords ) );
+
+    memset( gaLetterBits, 0, sizeof( gaLetterBits ) );
+    for( int word = 0; word < gnUniqueWords; ++word )
+        for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+            if (gaHash[ word ] & (1 << iLetter))
+                gaLetterBits[ iLetter ][ word >> 6 ] |= 1ull << (word & 63);
+
+#pragma omp parallel for
+    for( int word0 = 0; word0 < gnUniqueWords; ++word0 )
+    {
+        uint64_t *pBits = gpBitsets + (size_t) word0 * gnBitsetWords;
+        for( int iBits = 0; iBits < gnBitsetWords; ++iBits )
+            pBits[ iBits ] = ~0ull;
+
+        for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+            if (gaHash[ word0 ] & (1 << iLetter))
+                for( int iBits = 0; iBits < gnBitsetWords; ++iBits )
+                    pBits[ iBits ] &= ~gaLetterBits[ iLetter ][ iBits ];
+
+        // Only keep forward neighbors, word1 > word0, and only valid words
+        for( int iBits = 0; iBits < (word0 >> 6); ++iBits )
+            pBits[ iBits ] = 0;
+        pBits[ word0 >> 6 ] &= ~0ull << (word0 & 63) << 1;
+        if (gnUniqueWords & 63)
+            pBits[ gnBitsetWords-1 ] &= ~(~0ull << (gnUniqueWords & 63));
+    }
+}
+
+// pOut = pIn & the bitset of word, returns the number of candidates left.
+// Bits below word are always zero so only [word/64, gnBitsetWords) needs to be intersected.
+// ======================================================================
+inline int BitsetAnd( const uint64_t *pIn, int word, uint64_t *pOut )
+{
+    const uint64_t *pBits  = gpBitsets + (size_t) word * gnBitsetWords;
+          int       nCount = 0;
+
+    for( int iBits = word >> 6; iBits < gnBitsetWords; ++iBits )
+    {
+        pOut[ iBits ] = pIn[ iBits ] & pBits[ iBits ];
+        nCount += __builtin_popcountll( pOut[ iBits ] );
+    }
+    return nCount;
+}
+
+// Bron-Kerbosch style: each level's candidate set is the previous set AND the new word's forward neighbors
+// ======================================================================
+void SearchBitset()
+{
+#pragma omp parallel for schedule(dynamic)
+    for (int word0 = 0; word0 < gnUniqueWords; ++word0)
+    {
+        int       iThread = omp_get_thread_num();
+        uint64_t *pCand0  = gpBitsets     + (size_t) word0 * gnBitsetWords;
+        uint64_t *pCand1  = gpBitsetLevel + (size_t) iThread * (NUM_WORDS-2) * gnBitsetWords;
+        uint64_t *pCand2  = pCand1 + gnBitsetWords;
+        uint64_t *pCand3  = pCand2 + gnBitsetWords;
+
+        for (int iBits0 = word0 >> 6; iBits0 < gnBitsetWords; ++iBits0)
+        for (uint64_t nBits0 = pCand0[ iBits0 ]; nBits0; nBits0 &= nBits0 - 1)
+        {
+            int word1 = (iBits0 << 6) + __builtin_ctzll( nBits0 );
+            if (BitsetAnd( pCand0, word1, pCand1 ) < NUM_WORDS-2) // need word2, word3, word4
+                continue;
+
+            for (int iBits1 = word1 >> 6; iBits1 < gnBitsetWords; ++iBits1)
+            for (uint64_t nBits1 = pCand1[ iBits1 ]; nBits1; nBits1 &= nBits1 - 1)
+            {
+                int word2 = (iBits1 << 6) + __builtin_ctzll( nBits1 );
+                if (BitsetAnd( pCand1, word2, pCand2 ) < NUM_WORDS-3)
+                    continue;
+
+                for (int iBits2 = word2 >> 6; iBits2 < gnBitsetWords; ++iBits2)
+                for (uint64_t nBits2 = pCand2[ iBits2 ]; nBits2; nBits2 &= nBits2 - 1)
+                {
+                    int word3 = (iBits2 << 6) + __builtin_ctzll( nBits2 );
+                    int nCand3 = BitsetAnd( pCand2, word3, pCand3 );
+                    if (nCand3 < NUM_WORDS-4)
+                        continue;
+
+                    // Survivors missing a letter are the ones without that letter's bit
+                    if (CountLeaves())
+                    {
+                        int nUsed = gaHash[ word0 ] | gaHash[ word1 ] | gaHash[ word2 ] | gaHash[ word3 ];
+                        for( int nFree = ~nUsed & ALL_LETTERS; nFree; nFree &= nFree - 1 )
+                        {
+                            int iLetter = __builtin_ctz( nFree );
+                            int nWith   = 0;
+                            for (int iBits3 = word3 >> 6; iBits3 < gnBitsetWords; ++iBits3)
+                                nWith += __builtin_popcountll( pCand3[ iBits3 ] & gaLetterBits[ iLetter ][ iBits3 ] );
+                            AddLeaves( iThread, iLetter, nCand3 - nWith );
+                        }
+                        continue;
+                    }
+
+                    for (int iBits3 = word3 >> 6; iBits3 < gnBitsetWords; ++iBits3)
+                    for (uint64_t nBits3 = pCand3[ iBits3 ]; nBits3; nBits3 &= nBits3 - 1) // every candidate completes a clique
+                    {
+                        Emit( iThread, word0, word1, word2, word3, (iBits3 << 6) + __builtin_ctzll( nBits3 ) );
+                    }
+                }
+            }
+        }
+    }
+
+    free( gpBitsets     );
+    free( gpBitsetLevel );
+    gpBitsets     = NULL;
+    gpBitsetLevel = NULL;
+}
+
+// Counting engine, the cliques are never enumerated
+// ======================================================================
+void PrepareZeta()
+{
+    gbCount = true;
+
+    gpZeta = (uint32_t*) malloc( sizeof( uint32_t ) << NUM_LETTERS );
+    if (!gpZeta)
+        exit( printf( "ERROR: Couldn't allocate memory for %d MB zeta table\n", (int)((sizeof( uint32_t ) << NUM_LETTERS) >> 20) ) );
+}
+
+// Counts the cliques missing each letter, weighting each word by its number of anagrams if bAnagrams
+// ======================================================================
+void ZetaCount( bool bAnagrams, uint64_t *pMissing )
+{
+    const int nMasks = 1 << NUM_LETTERS;
+    const int nBlock = 1 << 16;
+
+#pragma omp parallel for
+    for( int iMask = 0; iMask < nMasks; ++iMask )
+        gpZeta[ iMask ] = 0;
+    for( int word = 0; word < gnUniqueWords; ++word )
+        gpZeta[ gaHash[ word ] ] = bAnagrams ? gaAnagrams[ word ] : 1;
+
+    // Zeta transform, afterwards gpZeta[T] = number of words that are a subset of T.
+    // The low 16 letters are transformed within 256 KB blocks that stay in L2, then the high letters across blocks
+#pragma omp parallel for
+    for( int iBlock = 0; iBlock < nMasks; iBlock += nBlock )
+        for( int nBit = 1; nBit < nBlock; nBit *= 2 )
+            for( int iMask = iBlock; iMask < iBlock + nBlock; iMask += 2*nBit )
+                for( int iLow = iMask; iLow < iMask + nBit; ++iLow )
+                    gpZeta[ iLow + nBit ] += gpZeta[ iLow ];
+
+    for( int nBit = nBlock; nBit < nMasks; nBit *= 2 )
+#pragma omp parallel for
+        for( int iMask = 0; iMask < nMasks; iMask += 2*nBit )
+            for( int iLow = iMask; iLow < iMask + nBit; ++iLow )
+                gpZeta[ iLow + nBit ] += gpZeta[ iLow ];
+
+    // Ranked subset convolution: since every word has exactly NUM_CHARS letters, the number of ordered NUM_WORDS-tuples of
+    // disjoint words whose union is exactly S, |S| = 25, is the Moebius transform of zeta^5 at S:
+    //     sum over T subset of S of (-1)^(|S| - |T|) * gpZeta[T]^5
+    // Each S is all letters but one so T contributes to every letter it is missing.
+    // Computed mod 2^64 which is exact since the result is small, even though zeta^5 overflows.
+    const int nCover = NUM_WORDS * NUM_CHARS;
+
+    for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+        pMissing[ iLetter ] = 0;
+
+#pragma omp parallel
+    {
+        uint64_t aSum[ NUM_LETTERS ] = { 0 };
+
+#pragma omp for
+        for( int iMask = 0; iMask < nMasks; ++iMask )
+        {
+            uint64_t nPower = 1;
+            for( int iWord = 0; iWord < NUM_WORDS; ++iWord )
+                nPower *= gpZeta[ iMask ];
+            if (!nPower)
+                continue;
+
+            if ((nCover - __builtin_popcount( iMask )) & 1)
+                nPower = 0 - nPower;
+
+            for( int nFree = ~iMask & ALL_LETTERS; nFree; nFree &= nFree - 1 )
+                aSum[ __builtin_ctz( nFree ) ] += nPower;
+        }
+
+#pragma omp critical
+        for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+            pMissing[ iLetter ] += aSum[ iLetter ];
+    }
+
+    uint64_t nOrderings = 1; // NUM_WORDS!
+    for( int iWord = 2; iWord <= NUM_WORDS; ++iWord )
+        nOrderings *= iWord;
+    for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+        pMissing[ iLetter ] /= nOrderings;
+}
+
+// Counts the cliques via subset convolution over letter masks, in time independent of the number of cliques
+// ======================================================================
+void SearchZeta()
+{
+    uint64_t aMissing[ NUM_LETTERS ];
+
+    ZetaCount( false, aMissing );
+    for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+    {
+        gaSinks[ 0 ].nSolutions += (int) aMissing[ iLetter ];
+        if (!gbAnagrams)
+            gaSinks[ 0 ].aMissing[ iLetter ] += (int) aMissing[ iLetter ];
+    }
+
+    // Same as Emit(): with -anagrams the counts per missing letter include anagrams
+    if (gbAnagrams)
+    {
+        ZetaCount( true, aMissing );
+        for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+        {
+            gaSinks[ 0 ].aMissing[ iLetter ] += (int) aMissing[ iLetter ];
+            gaSinks[ 0 ].nAnagrams           += (int) aMissing[ iLetter ];
+        }
+    }
+}
+
+// Sorts the alphabet by the number of words with each letter, rarest first; ties are kept in alphabetical order
+// ======================================================================
+void LetterOrder()
+{
+    int aFrequency[ NUM_LETTERS ] = { 0 };
+    for( int word = 0; word < gnUniqueWords; ++word )
+        for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+            aFrequency[ iLetter ] += (gaHash[ word ] >> iLetter) & 1;
+
+    // Insertion sort
+    for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+    {
+        int iRank = iLetter;
+        for( ; (iRank > 0) && (aFrequency[ gaLetterOrder[ iRank-1 ] ] > aFrequency[ iLetter ]); --iRank )
+            gaLetterOrder[ iRank ] = gaLetterOrder[ iRank-1 ];
+        gaLetterOrder[ iRank ] = iLetter;
+    }
+}
+
+// Orders the alphabet by letter frequency and buckets words by their rarest letter
+// ======================================================================
+void PrepareRare()
+{
+    LetterOrder();
+
+    int aRank[ NUM_LETTERS ];
+    for( int iRank = 0; iRank < NUM_LETTERS; ++iRank )
+        aRank[ gaLetterOrder[ iRank ] ] = iRank;
+
+    int aCount[ NUM_LETTERS+1 ] = { 0 };
+    for( int word = 0; word < gnUniqueWords; ++word )
+    {
+        int nHash = 0;
+        for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+            if (gaHash[ word ] & (1 << iLetter))
+                nHash |= 1 << aRank[ iLetter ];
+
+        gaRareHash[ word ] = nHash;
+        aCount[ __builtin_ctz( nHash ) ]++; // lowest bit = rarest letter
+    }
+
+    gaRareStart[ 0 ] = 0;
+    for( int iRank = 0; iRank < NUM_LETTERS; ++iRank )
+        gaRareStart[ iRank+1 ] = gaRareStart[ iRank ] + aCount[ iRank ];
+
+    for( int word = 0; word < gnUniqueWords; ++word )
+    {
+        int iBucket = __builtin_ctz( gaRareHash[ word ] );
+        gaRareWords[ gaRareStart[ iBucket+1 ] - aCount[ iBucket ]-- ] = (short) word;
+    }
+}
+
+// Always branches on the lowest (rarest) letter not yet covered.
+// Every word that can cover it has that letter as its rarest, so only that one bucket needs to be scanned.
+// A clique covers 25 of the 26 letters so exactly one letter may be skipped instead.
+// ======================================================================
+void SearchRareFrom( int iThread, int nUsed, int nDepth, bool bSkipped, short *pWords )
+{
+    if (nDepth == NUM_WORDS)
+    {
+        Emit( iThread, pWords[0], pWords[1], pWords[2], pWords[3], pWords[4] );
+        return;
+    }
+
+    int iLetter = __builtin_ctz( ~nUsed );
+    int iEnd    = gaRareStart[ iLetter+1 ];
+
+    // -count: the last word's survivors are counted in place; nUsed may hold the skipped letter, so use the real masks
+    if ((nDepth == NUM_WORDS-1) && CountLeaves())
+    {
+        int nWords = gaHash[ pWords[0] ] | gaHash[ pWords[1] ] | gaHash[ pWords[2] ] | gaHash[ pWords[3] ];
+        for( int iWord = gaRareStart[ iLetter ]; iWord < iEnd; ++iWord )
+            if (!(gaRareHash[ gaRareWords[ iWord ] ] & nUsed))
+                AddLeaves( iThread, __builtin_ctz( ~(nWords | gaHash[ gaRareWords[ iWord ] ]) & ALL_LETTERS ), 1 );
+
+        if (!bSkipped)
+            SearchRareFrom( iThread, nUsed | (1 << iLetter), nDepth, true, pWords );
+        return;
+    }
+
+    for( int iWord = gaRareStart[ iLetter ]; iWord < iEnd; ++iWord )
+    {
+        int word = gaRareWords[ iWord ];
+        if (gaRareHash[ word ] & nUsed)
+            continue;
+
+        pWords[ nDepth ] = (short) word;
+        SearchRareFrom( iThread, nUsed | gaRareHash[ word ], nDepth+1, bSkipped, pWords );
+    }
+
+    if (!bSkipped)
+        SearchRareFrom( iThread, nUsed | (1 << iLetter), nDepth, true, pWords );
+}
+
+// ======================================================================
+void SearchRare()
+{
+    // The first level is either a word from the rarest letter's bucket,
+    // or skipping the rarest letter and a word from the 2nd rarest letter's bucket
+    int nRarest = gaRareStart[ 1 ] - gaRareStart[ 0 ];
+    int nJobs   = gaRareStart[ 2 ] - gaRareStart[ 0 ];
+
+#pragma omp parallel for schedule(dynamic)
+    for( int iJob = 0; iJob < nJobs; ++iJob )
+    {
+        int   iThread  = omp_get_thread_num();
+        bool  bSkipped = (iJob >= nRarest);
+        int   word0    = gaRareWords[ gaRareStart[ 0 ] + iJob ];
+        short aWords[ NUM_WORDS ];
+
+        aWords[ 0 ] = (short) word0;
+        SearchRareFrom( iThread, gaRareHash[ word0 ] | (int) bSkipped, 1, bSkipped, aWords );
+    }
+}
+
+// Prints every combination of anagrams of one solution, the Cartesian product of the anagram groups of its words
+// ======================================================================
+int ExpandAnagrams( const short *pWord )
+{
+    int aAnagram[ NUM_WORDS ];
+    for (int iWord = 0; iWord < NUM_WORDS; ++iWord)
+        aAnagram[ iWord ] = gaAnagramHead[ pWord[ iWord ] ];
+
+    int nExpanded = 0;
+    for (bool bMore = true; bMore; nExpanded++)
+    {
+        printf( "   " );
+        for (int iWord = 0; iWord < NUM_WORDS; ++iWord)
+            printf( " %.*s,", NUM_CHARS, gpAnagramWords[ aAnagram[ iWord ] ] );
+        printf( "\n" );
+
+        // Odometer: advance the last word, carry into the previous ones
+        bMore = false;
+        for (int iWord = NUM_WORDS-1; (iWord >= 0) && !bMore; --iWord)
+        {
+            aAnagram[ iWord ] = gpAnagramNext[ aAnagram[ iWord ] ];
+            bMore = (aAnagram[ iWord ] >= 0);
+            if (!bMore)
+                aAnagram[ iWord ] = gaAnagramHead[ pWord[ iWord ] ];
+        }
+    }
+    return nExpanded;
+}
+
+// A clique covers every letter but one, so the search splits into one subproblem per missing letter.
+// Each subproblem only has the words without that letter, and exactly one of its words has the subproblem's rarest letter.
+// That word is word0, which makes a job; the other 4 words are enumerated in ascending order.
+// ======================================================================
+void PrepareSplit()
+{
+    gbGroup = true;
+
+    LetterOrder();
+
+    int aCount[ NUM_LETTERS ] = { 0 };
+    for( int word = 0; word < gnUniqueWords; ++word )
+        for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+            aCount[ iLetter ] += !((gaHash[ word ] >> iLetter) & 1);
+
+    gaSplitStart[ 0 ] = 0;
+    for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+        gaSplitStart[ iLetter+1 ] = gaSplitStart[ iLetter ] + aCount[ iLetter ];
+
+    gpSplitWords = (short   *) malloc( sizeof( short    ) * gaSplitStart[ NUM_LETTERS ] );
+    gpSplitJobs  = (SplitJob*) malloc( sizeof( SplitJob ) * gnUniqueWords * NUM_LETTERS );
+    if (!gpSplitWords || !gpSplitJobs)
+        exit( printf( "ERROR: Couldn't allocate memory for %d words\n", gaSplitStart[ NUM_LETTERS ] ) );
+
+    gnSplitJobs = 0;
+    for( int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter )
+    {
+        int nRare = 1 << gaLetterOrder[ (gaLetterOrder[ 0 ] == iLetter) ? 1 : 0 ];
+        int nWord = gaSplitStart[ iLetter ];
+
+        for( int word = 0; word < gnUniqueWords; ++word )
+        {
+            if (gaHash[ word ] & (1 << iLetter))
+                continue;
+
+            gpSplitWords[ nWord++ ] = (short) word;
+            if (gaHash[ word ] & nRare)
+            {
+                gpSplitJobs[ gnSplitJobs ].word0   = (short) word;
+                gpSplitJobs[ gnSplitJobs ].iLetter = (short) iLetter;
+                gnSplitJobs++;
+            }
+        }
+    }
+
+    gpSplitCands = AllocThreadRows();
+
+    printf( "%6d jobs for %d missing letters\n", gnSplitJobs, NUM_LETTERS );
+}
+
+// ======================================================================
+void SearchSplit()
+{
+#pragma omp parallel for schedule(dynamic)
+    for (int iJob = 0; iJob < gnSplitJobs; ++iJob)
+    {
+        int    iThread = omp_get_thread_num();
+        int    word0   = gpSplitJobs[ iJob ].word0;
+        int    iLetter = gpSplitJobs[ iJob ].iLetter;
+        short *pCand1  = ThreadRows( gpSplitCands, iThread, 0 );
+        short *pCand2  = ThreadRows( gpSplitCands, iThread, 1 );
+        short *pCand3  = ThreadRows( gpSplitCands, iThread, 2 );
+        short *pCand4  = ThreadRows( gpSplitCands, iThread, 3 );
+
+        // word0's row of this letter's graph, in both directions
+        int nCand1 = gpFilter( gpSplitWords + gaSplitStart[ iLetter ], gaSplitStart[ iLetter+1 ] - gaSplitStart[ iLetter ], gaHash[ word0 ], pCand1 );
+
+        for (int iCand1 = 0; iCand1 < nCand1; ++iCand1)
+        {
+            int word1  = pCand1[ iCand1 ];
+            int nCand2 = gpFilter( pCand1 + iCand1 + 1, nCand1 - iCand1 - 1, gaHash[ word1 ], pCand2 );
+
+            for (int iCand2 = 0; iCand2 < nCand2; ++iCand2)
+            {
+                int word2  = pCand2[ iCand2 ];
+                int nCand3 = gpFilter( pCand2 + iCand2 + 1, nCand2 - iCand2 - 1, gaHash[ word2 ], pCand3 );
+
+                for (int iCand3 = 0; iCand3 < nCand3; ++iCand3)
+                {
+                    int word3  = pCand3[ iCand3 ];
+                    int nCand4 = gpFilter( pCand3 + iCand3 + 1, nCand3 - iCand3 - 1, gaHash[ word3 ], pCand4 );
+
+                    if (CountLeaves()) // the job's letter is the missing one
+                    {
+                        AddLeaves( iThread, iLetter, nCand4 );
+                        continue;
+                    }
+
+                    for (int iCand4 = 0; iCand4 < nCand4; ++iCand4) // every survivor completes a clique
+                    {
+                        Emit( iThread, word0, word1, word2, word3, pCand4[ iCand4 ] );
+                    }
+                }
+            }
+        }
+    }
+
+    free( gpSplitCands );
+    gpSplitCands = NULL;
+}
+
+// Prints one solution, or every combination of its anagrams.  Returns the number of lines
+// ======================================================================
+int PrintSolution( const short *pWord )
+{
+    if (gbAnagrams)
+        return ExpandAnagrams( pWord );
+
+    printf( "   " );
+    for (int iWord = 0; iWord < NUM_WORDS; ++iWord)
+        printf( " %.*s,", NUM_CHARS, gaWords[ pWord[ iWord ] ] );
+    printf( "\n" );
+    return 1;
+}
+
+// ======================================================================
+inline int MissingLetter( const short *pWord )
+{
+    int nUsed = 0;
+    for (int iWord = 0; iWord < NUM_WORDS; ++iWord)
+        nUsed |= gaHash[ pWord[ iWord ] ];
+    return __builtin_ctz( ~nUsed & ALL_LETTERS );
+}
+
+// Prints the stored solutions of every thread that are missing this letter, returns the number of lines
+// ======================================================================
+int PrintMissing( int iLetter )
+{
+    int nLines = 0;
+
+    for (int iThread = 0; iThread < MAX_THREADS; ++iThread)
+    for (const ResultChunk *pChunk = gaSinks[ iThread ].pHead; pChunk; pChunk = pChunk->pNext)
+    for (int iSolution = 0; iSolution < pChunk->nSolutions; ++iSolution)
+    {
+        const short *pWord = &pChunk->aWords[ iSolution*NUM_WORDS ];
+        if (MissingLetter( pWord ) == iLetter)
+            nLines += PrintSolution( pWord );
+    }
+    return nLines;
+}
+
+// With -count the solutions by their first missing letter, when a solution can't use every letter; then the totals
+// ======================================================================
+void PrintTotals( const int *pMissing, int nSkips, int nTotal, int nThreads, bool bAnagrams, int nAnagrams )
+{
+    if (gbCount && nSkips)
+        for( int iLetter = 0; iLetter < gnAlphabet; ++iLetter )
+            printf( "Missing %.*s%s: %d\n", gaLetterBytes[ iLetter ], gaLetterText[ iLetter ], (nSkips > 1) ? " first" : "", pMissing[ iLetter ] );
+
+    printf( "Solutions: %d   \n", nTotal   );
+    if (bAnagrams)
+        printf( "Solutions with anagrams: %d\n", nAnagrams );
+    printf( "Threads with solutions: %d\n", nThreads );
+}
+
+// ======================================================================
+void Solutions()
+{
+    // Gather
+    int nTotal    = 0;
+    int nThreads  = 0;
+    int nAnagrams = 0;
+
+    int aMissing[ NUM_LETTERS ] = { 0 };
+
+    for (int iThread = 0; iThread < MAX_THREADS; ++iThread)
+    {
+        const ResultSink *pSink = &gaSinks[ iThread ];
+
+        nTotal     +=  pSink->nSolutions     ;
+        nThreads   += (pSink->nSolutions > 0);
+        nAnagrams  +=  pSink->nAnagrams      ;
+
+        for (int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter)
+            aMissing[ iLetter ] += pSink->aMissing[ iLetter ];
+
+        if ((pSink->nSolutions > 0) && !gbCount && !gbGroup)
+            printf( "Thread %d found %d solutions:\n", iThread, pSink->nSolutions );
+
+        for (const ResultChunk *pChunk = pSink->pHead; pChunk; pChunk = pChunk->pNext)
+        for (int iSolution = 0; iSolution < pChunk->nSolutions; ++iSolution)
+        {
+            const short *pWord = &pChunk->aWords[ iSolution*NUM_WORDS ];
+            if (gbGroup)
+                aMissing[ MissingLetter( pWord ) ]++;
+            else
+                nAnagrams += PrintSolution( pWord );
+        }
+    }
+
+    if (gbGroup)
+        for (int iLetter = 0; iLetter < NUM_LETTERS; ++iLetter)
+            if (aMissing[ iLetter ] && !gbCount)
+            {
+                printf( "Missing %c found %d solutions:\n", 'a' + iLetter, aMissing[ iLetter ] );
+                nAnagrams += PrintMissing( iLetter );
+            }
+
+    PrintTotals( aMissing, NUM_LETTERS - NUM_WORDS*NUM_CHARS, nTotal, nThreads, gbAnagrams, nAnagrams );
+}
+
+// Prints the solutions of every thread, nWords per solution, then the totals
+// ======================================================================
+void WordSolutions( const WordSink *pSinks, int nWords, int nSkips, void (*PrintWord)( int word ) )
+{
+    int nTotal   = 0;
+    int nThreads = 0;
+    int aMissing[ MAX_LETTERS ] = { 0 };
+
+    for( int iThread = 0; iThread < MAX_THREADS; ++iThread )
+    {
+        const WordSink *pSink = &pSinks[ iThread ];
+
+        nTotal   +=  pSink->nSolutions     ;
+        nThreads += (pSink->nSolutions > 0);
+
+        for( int iLetter = 0; iLetter < gnAlphabet; ++iLetter )
+            aMissing[ iLetter ] += pSink->aMissing[ iLetter ];
+
+        if (gbCount)
+            continue;
+
+        if (pSink->nSolutions > 0)
+            printf( "Thread %d found %d solutions:\n", iThread, pSink->nSolutions );
+
+        for( int iSolution = 0; iSolution < pSink->nSolutions; ++iSolution )
+        {
+            printf( "   " );
+            for( int iWord = 0; iWord < nWords; ++iWord )
+                PrintWord( pSink->pWords[ nWords*iSolution + iWord ] );
+            printf( "\n" );
+        }
+    }
+
+    PrintTotals( aMissing, nSkips, nTotal, nThreads, false, 0 );
+}
+
+    // Letter masks wider than 64 bits are two 64-bit lanes, so AND and the zero test stay plain lane operations
+    struct alignas(16) Mask128
+    {
+        uint64_t lo;
+        uint64_t hi;
+    };
+    inline Mask128 operator & ( Mask128 a, Mask128 b ) { return { a.lo & b.lo, a.hi & b.hi }; }
+    inline Mask128 operator | ( Mask128 a, Mask128 b ) { return { a.lo | b.lo, a.hi | b.hi }; }
+    inline bool    operator ==( Mask128 a, Mask128 b ) { return (a.lo == b.lo) && (a.hi == b.hi); }
+    inline bool    operator !=( Mask128 a, Mask128 b ) { return !(a == b); }
+
+    inline bool     IsEmpty ( uint64_t n ) { return !n; }
+    inline bool     IsEmpty ( Mask128  n ) { return !(n.lo | n.hi); }
+    inline uint64_t MaskHash( uint64_t n ) { return n * 0x9E3779B97F4A7C15ull; }
+    inline uint64_t MaskHash( Mask128  n ) { return (n.lo ^ (n.hi * 0xC2B2AE3D27D4EB4Full)) * 0x9E3779B97F4A7C15ull; }
+
+    template< typename Mask > inline Mask    MaskBit( int iBit ) { return (Mask)1 << iBit; }
+    template<>                inline Mask128 MaskBit< Mask128 >( int iBit ) { return (iBit < 64) ? Mask128{ 1ull << iBit, 0 } : Mask128{ 0, 1ull << (iBit - 64) }; }
+
+// Reads the letters of -alphabet=@file.  Line endings and a UTF-8 byte order mark are ignored
+// ======================================================================
+const char* ReadAlphabet( const char *filename )
+{
+    static char aText[ 3*MAX_LETTERS + 8 ];             // BMP letters are at most 3 bytes, + BOM and line ending
+
+    FILE *file = fopen( filename, "rb" );
+    if (!file)
+        exit( printf( "ERROR: Couldn't open alphabet file: %s\n", filename ) );
+    size_t nSize = fread( aText, 1, sizeof( aText ), file );
+    fclose( file );
+    if (nSize == sizeof( aText ))
+        exit( printf( "ERROR: More than %d letters in the alphabet\n", MAX_LETTERS ) );
+
+    size_t iText = (nSize >= 3) && (memcmp( aText, "\xEF\xBB\xBF", 3 ) == 0) ? 3 : 0;
+    size_t nText = 0;
+    for( ; iText < nSize; ++iText )
+        if ((aText[ iText ] != '\r') && (aText[ iText ] != '\n'))
+            aText[ nText++ ] = aText[ iText ];
+    aText[ nText ] = 0;
+    return aText;
+}
+
+// Decodes one UTF-8 code point and advances past it, returns -1 if it is invalid
+// ======================================================================
+inline int DecodeUtf8( const char **ppText, const char *pEnd )
+{
+    const unsigned char *pByte = (const unsigned char*) *ppText;
+
+    int nCode = pByte[0];
+    int nMore = 0;
+    if      (nCode < 0x80)           nMore = 0;
+    else if ((nCode & 0xE0) == 0xC0) nMore = 1, nCode &= 0x1F;
+    else if ((nCode & 0xF0) == 0xE0) nMore = 2, nCode &= 0x0F;
+    else if ((nCode & 0xF8) == 0xF0) nMore = 3, nCode &= 0x07;
+    else
+        return -1;
+
+    if (pEnd - *ppText <= nMore)
+        return -1;
+    for( int iByte = 1; iByte <= nMore; ++iByte )
+    {
+        if ((pByte[ iByte ] & 0xC0) != 0x80)
+            return -1;
+        nCode = (nCode << 6) | (pByte[ iByte ] & 0x3F);
+    }
+
+    *ppText += 1 + nMore;
+    return nCode;
+}
+
+// Maps each code point of the UTF-8 string to the next bit, i.e. "abcdefghijklmnopqrstuvwxyzæøå" is Danish
+// ======================================================================
+void SetAlphabet( const char *pText )
+{
+    memset( gaLetterBit, NO_LETTER, sizeof( gaLetterBit ) );
+    gnAlphabet = 0;
+
+    for( const char *pEnd = pText + strlen( pText ); pText < pEnd; )
+    {
+        const char *pLetter = pText;
+        int         nCode   = DecodeUtf8( &pText, pEnd );
+        if ((nCode < 0) || (nCode >= MAX_CODE))
+            exit( printf( "ERROR: Alphabet letter %d isn't UTF-8 in the Basic Multilingual Plane\n", gnAlphabet + 1 ) );
+        if (gaLetterBit[ nCode ] != NO_LETTER)
+            exit( printf( "ERROR: Alphabet letter %.*s is repeated\n", (int)(pText - pLetter), pLetter ) );
+        if (gnAlphabet == MAX_LETTERS)
+            exit( printf( "ERROR: More than %d letters in the alphabet\n", MAX_LETTERS ) );
+
+        gaLetterText [ gnAlphabet ] = pLetter;
+        gaLetterBytes[ gnAlphabet ] = (int)(pText - pLetter);
+        gaLetterBit  [ nCode      ] = (unsigned char) gnAlphabet++;
+    }
+}
+
+// Copies the word indices whose masks don't share any letters with nMask, like FilterScalar() for the masks of a Puzzle<>
+// ======================================================================
+template< typename Mask >
+int FilterMaskScalar( const Mask *pMasks, const int *pIn, int nIn, Mask nMask, int *pOut )
+{
+    int nOut = 0;
+    for( int iIn = 0; iIn < nIn; ++iIn )
+    {
+        pOut[ nOut ] = pIn[ iIn ];
+        nOut += IsEmpty( pMasks[ pIn[ iIn ] ] & nMask ); // branchless
+    }
+    return nOut;
+}
+
+#if USE_SIMD
+// Tests 8 candidates at once: gather their masks, AND, then left pack the survivors with vpermd
+// ======================================================================
+TARGET_AVX2 int FilterMaskAVX2( const uint32_t *pMasks, const int *pIn, int nIn, uint32_t nMask, int *pOut )
+{
+    const __m256i vMask = _mm256_set1_epi32( (int) nMask );
+    const __m256i vZero = _mm256_setzero_si256();
+
+    int nOut = 0;
+    int iIn  = 0;
+    for( ; iIn + 8 <= nIn; iIn += 8 )
+    {
+        __m256i vWords = _mm256_loadu_si256( (const __m256i*)(pIn + iIn) );
+        __m256i vMasks = _mm256_i32gather_epi32( (const int*) pMasks, vWords, 4 );
+        __m256i vValid = _mm256_cmpeq_epi32( _mm256_and_si256( vMasks, vMask ), vZero );
+        int     nKeep  = _mm256_movemask_ps( _mm256_castsi256_ps( vValid ) );
+
+        // Always stores 8 words; safe since nOut <= iIn
+        _mm256_storeu_si256( (__m256i*)(pOut + nOut), _mm256_permutevar8x32_epi32( vWords, _mm256_loadu_si256( (const __m256i*) gaCompress32[ nKeep ] ) ) );
+        nOut += __builtin_popcount( nKeep );
+    }
+    return nOut + FilterMaskScalar( pMasks, pIn + iIn, nIn - iIn, nMask, pOut + nOut );
+}
+
+// Same with two gathers of 4 masks
+// ======================================================================
+TARGET_AVX2 int FilterMaskAVX2( const uint64_t *pMasks, const int *pIn, int nIn, uint64_t nMask, int *pOut )
+{
+    const __m256i vMask = _mm256_set1_epi64x( (long long) nMask );
+    const __m256i vZero = _mm256_setzero_si256();
+
+    int nOut = 0;
+    int iIn  = 0;
+    for( ; iIn + 8 <= nIn; iIn += 8 )
+    {
+        __m256i vWords = _mm256_loadu_si256( (const __m256i*)(pIn + iIn) );
+        __m256i vLo    = _mm256_i32gather_epi64( (const long long*) pMasks, _mm256_castsi256_si128     ( vWords    ), 8 );
+        __m256i vHi    = _mm256_i32gather_epi64( (const long long*) pMasks, _mm256_extracti128_si256( vWords, 1 ), 8 );
+        int     nKeep  = _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpeq_epi64( _mm256_and_si256( vLo, vMask ), vZero ) ) )
+                       | _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpeq_epi64( _mm256_and_si256( vHi, vMask ), vZero ) ) ) << 4;
+
+        _mm256_storeu_si256( (__m256i*)(pOut + nOut), _mm256_permutevar8x32_epi32( vWords, _mm256_loadu_si256( (const __m256i*) gaCompress32[ nKeep ] ) ) );
+        nOut += __builtin_popcount( nKeep );
+    }
+    return nOut + FilterMaskScalar( pMasks, pIn + iIn, nIn - iIn, nMask, pOut + nOut );
+}
+
+// Mask128 is two 64-bit lanes: gather the low and high lanes of 4 masks separately, AND each with its lane of nMask, then OR
+// ======================================================================
+TARGET_AVX2 int FilterMaskAVX2( const Mask128 *pMasks, const int *pIn, int nIn, Mask128 nMask, int *pOut )
+{
+    const __m256i vMaskLo = _mm256_set1_epi64x( (long long) nMask.lo );
+    const __m256i vMaskHi = _mm256_set1_epi64x( (long long) nMask.hi );
+    const __m256i vZero   = _mm256_setzero_si256();
+    const long long *pLanes = (const long long*) pMasks; // lo, hi, lo, hi, ...
+
+    int nOut = 0;
+    int iIn  = 0;
+    for( ; iIn + 8 <= nIn; iIn += 8 )
+    {
+        __m256i vWords = _mm256_loadu_si256( (const __m256i*)(pIn + iIn) );
+        __m256i vLanes = _mm256_slli_epi32( vWords, 1 );
+        int     nKeep  = 0;
+        for( int iHalf = 0; iHalf < 2; ++iHalf )
+        {
+            __m128i vIndex = iHalf ? _mm256_extracti128_si256( vLanes, 1 ) : _mm256_castsi256_si128( vLanes );
+            __m256i vLo    = _mm256_i32gather_epi64( pLanes    , vIndex, 8 );
+            __m256i vHi    = _mm256_i32gather_epi64( pLanes + 1, vIndex, 8 );
+            __m256i vUsed  = _mm256_or_si256( _mm256_and_si256( vLo, vMaskLo ), _mm256_and_si256( vHi, vMaskHi ) );
+            nKeep |= _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpeq_epi64( vUsed, vZero ) ) ) << (4*iHalf);
+        }
+
+        _mm256_storeu_si256( (__m256i*)(pOut + nOut), _mm256_permutevar8x32_epi32( vWords, _mm256_loadu_si256( (const __m256i*) gaCompress32[ nKeep ] ) ) );
+        nOut += __builtin_popcount( nKeep );
+    }
+    return nOut + FilterMaskScalar( pMasks, pIn + iIn, nIn - iIn, nMask, pOut + nOut );
+}
+
+// Tests 16 candidates at once: gather their masks, test, then compress store the survivors
+// ======================================================================
+TARGET_AVX512 int FilterMaskAVX512( const uint32_t *pMasks, const int *pIn, int nIn, uint32_t nMask, int *pOut )
+{
+    const __m512i vMask = _mm512_set1_epi32( (int) nMask );
+
+    int nOut = 0;
+    int iIn  = 0;
+    for( ; iIn + 16 <= nIn; iIn += 16 )
+    {
+        __m512i   vWords = _mm512_loadu_si512( pIn + iIn );
+        __m512i   vMasks = _mm512_i32gather_epi32( vWords, (const int*) pMasks, 4 );
+        __mmask16 nKeep  = _mm512_testn_epi32_mask( vMasks, vMask );
+
+        _mm512_storeu_si512( pOut + nOut, _mm512_maskz_compress_epi32( nKeep, vWords ) );
+        nOut += __builtin_popcount( nKeep );
+    }
+    return nOut + FilterMaskScalar( pMasks, pIn + iIn, nIn - iIn, nMask, pOut + nOut );
+}
+
+// Same with two gathers of 8 masks
+// ======================================================================
+TARGET_AVX512 int FilterMaskAVX512( const uint64_t *pMasks, const int *pIn, int nIn, uint64_t nMask, int *pOut )
+{
+    const __m512i vMask = _mm512_set1_epi64( (long long) nMask );
+
+    int nOut = 0;
+    int iIn  = 0;
+    for( ; iIn + 16 <= nIn; iIn += 16 )
+    {
+        __m512i   vWords = _mm512_loadu_si512( pIn + iIn );
+        __m512i   vLo    = _mm512_i32gather_epi64( _mm512_castsi512_si256     ( vWords    ), (const long long*) pMasks, 8 );
+        __m512i   vHi    = _mm512_i32gather_epi64( _mm512_extracti64x4_epi64( vWords, 1 ), (const long long*) pMasks, 8 );
+        __mmask16 nKeep  = (__mmask16)(_mm512_testn_epi64_mask( vLo, vMask ) | (_mm512_testn_epi64_mask( vHi, vMask ) << 8));
+
+        _mm512_storeu_si512( pOut + nOut, _mm512_maskz_compress_epi32( nKeep, vWords ) );
+        nOut += __builtin_popcount( nKeep );
+    }
+    return nOut + FilterMaskScalar( pMasks, pIn + iIn, nIn - iIn, nMask, pOut + nOut );
+}
+
+// Two-lane AND of 8 masks per half like FilterMaskAVX2( const Mask128* )
+// ======================================================================
+TARGET_AVX512 int FilterMaskAVX512( const Mask128 *pMasks, const int *pIn, int nIn, Mask128 nMask, int *pOut )
+{
+    const __m512i vMaskLo = _mm512_set1_epi64( (long long) nMask.lo );
+    const __m512i vMaskHi = _mm512_set1_epi64( (long long) nMask.hi );
+    const long long *pLanes = (const long long*) pMasks; // lo, hi, lo, hi, ...
+
+    int nOut = 0;
+    int iIn  = 0;
+    for( ; iIn + 16 <= nIn; iIn += 16 )
+    {
+        __m512i vWords = _mm512_loadu_si512( pIn + iIn );
+        __m512i vLanes = _mm512_slli_epi32( vWords, 1 );
+        int     nKeep  = 0;
+        for( int iHalf = 0; iHalf < 2; ++iHalf )
+        {
+            __m256i vIndex = iHalf ? _mm512_extracti64x4_epi64( vLanes, 1 ) : _mm512_castsi512_si256( vLanes );
+            __m512i vLo    = _mm512_i32gather_epi64( vIndex, pLanes    , 8 );
+            __m512i vHi    = _mm512_i32gather_epi64( vIndex, pLanes + 1, 8 );
+            nKeep |= (_mm512_testn_epi64_mask( vLo, vMaskLo ) & _mm512_testn_epi64_mask( vHi, vMaskHi )) << (8*iHalf);
+        }
+
+        _mm512_storeu_si512( pOut + nOut, _mm512_maskz_compress_epi32( (__mmask16) nKeep, vWords ) );
+        nOut += __builtin_popcount( nKeep );
+    }
+    return nOut + FilterMaskScalar( pMasks, pIn + iIn, nIn - iIn, nMask, pOut + nOut );
+}
+#endif // USE_SIMD
+
+// Any number of words of any length: a puzzle of WORDS words of CHARS letters, all different, with letter masks of type Mask.
+// The search levels are unrolled at compile time by recursing on the depth, so every shape is as tight as the hand written 5x5 loops.
+// ======================================================================
+template< int WORDS, int CHARS, typename Mask >
+struct Puzzle
+{
+    static inline int          gnWords    = 0;
+    static inline const char **gpWords    = NULL;       // NOT null terminated
+    static inline int         *gpBytes    = NULL;       // UTF-8 length of each word
+    static inline Mask        *gpMasks    = NULL;
+    static inline int         *gpStart    = NULL;       // CSR offsets of the forward neighbors, gnWords+1
+    static inline int         *gpNeighbors = NULL;
+    static inline int          gnMaxRow   = 0;
+    static inline WordSink     gaSinks[ MAX_THREADS ];
+    static inline int        (*gpFilter)( const Mask *pMasks, const int *pIn, int nIn, Mask nMask, int *pOut ) = FilterMaskScalar< Mask >; // Runtime dispatch, see Run()
+
+    // Returns the mask of a word of exactly CHARS different letters of the alphabet, or 0
+    // ======================================================================
+    static inline Mask WordMask( const char *pText, const char *pEnd )
+    {
+        Mask nMask = {};
+        for( int iChar = 0; iChar < CHARS; ++iChar )
+        {
+            if (pText >= pEnd)
+                return Mask{};
+
+            int nCode = DecodeUtf8( &pText, pEnd );
+            if ((nCode < 0) || (nCode >= MAX_CODE) || (gaLetterBit[ nCode ] == NO_LETTER))
+                return Mask{};
+
+            Mask nLetter = MaskBit< Mask >( gaLetterBit[ nCode ] );
+            if (!IsEmpty( nMask & nLetter ))
+                return Mask{};
+            nMask = nMask | nLetter;
+        }
+        return (pText == pEnd) ? nMask : Mask{};
+    }
+
+    // Tokenizes one line like ::ParseLine(), letters are 1 to 3 bytes
+    // ======================================================================
+    static void ParseLine( ParseChunk< Mask > *pChunk, const char *pText, const char *eol )
+    {
+        size_t len = (eol - pText);
+        if (len && (eol[-1] == '\r'))
+            len--;
+
+        pChunk->nTotalWords++;
+        if ((len < CHARS) || (len > 3*CHARS))
+            return;
+
+        Mask nMask = WordMask( pText, pText + len );
+        if (IsEmpty( nMask ))
+            return;
+
+        pChunk->nLengthWords++;
+        ChunkAdd( pChunk, pText, nMask );
+    }
+
+    // Tokenizes the chunks in parallel like ::Parse(), then keeps the first word of every mask, in dictionary order
+    // ======================================================================
+    static void Parse()
+    {
+        int                 nChunks = 0;
+        ParseChunk< Mask > *pChunks = ScanChunks< Mask, ParseLine >( &nChunks );
+
+        int nTotal    = 0;
+        int nLetters  = 0;
+        for( int iChunk = 0; iChunk < nChunks; ++iChunk )
+        {
+            nTotal   += pChunks[ iChunk ].nTotalWords;
+            nLetters += pChunks[ iChunk ].nLengthWords;
+        }
+
+        int   nSlots = 0;
+        int   nShift = 0;                                         // 64 - log2( nSlots )
+        for( nShift = 64 - 10, nSlots = 1024; nSlots < 2*nLetters; nSlots *= 2 )
+            nShift--;
+        Mask *pKeys  = (Mask*) calloc( nSlots, sizeof( Mask ) );  // open addressing hash table of unique masks, 0 = empty slot
+
+        gpWords = (const char**) malloc( sizeof( gpWords[0] ) * (nLetters + 1) );
+        gpBytes = (int        *) malloc( sizeof( gpBytes[0] ) * (nLetters + 1) );
+        gpMasks = (Mask       *) malloc( sizeof( gpMasks[0] ) * (nLetters + 1) );
+        if (!pKeys || !gpWords || !gpBytes || !gpMasks)
+            exit( printf( "ERROR: Couldn't allocate memory for %d words\n", nLetters ) );
+
+        const char *pEnd = gpBufferText + gnBufferSize;
+        for( int iChunk = 0; iChunk < nChunks; ++iChunk )
+        {
+            ParseChunk< Mask > *pChunk = &pChunks[ iChunk ];
+            for( int iWord = 0; iWord < pChunk->nWords; ++iWord )
+            {
+                Mask *pSlot = Find( pKeys, nSlots, nShift, pChunk->pHash[ iWord ] );
+                if (!IsEmpty( *pSlot ))
+                    continue; // skip anagrams
+                *pSlot = pChunk->pHash[ iWord ];
+
+                const char *pWord = pChunk->ppWords[ iWord ];
+                const char *eol   = (const char*) memchr( pWord, '\n', pEnd - pWord );
+                const char *pEol  = eol ? eol : pEnd;
+                if ((pEol > pWord) && (pEol[-1] == '\r'))
+                    pEol--;
+
+                gpWords[ gnWords ] = pWord;
+                gpBytes[ gnWords ] = (int)(pEol - pWord);
+                gpMasks[ gnWords ] = *pSlot;
+                gnWords++;
+            }
+
+            free( pChunk->ppWords );
+            free( pChunk->pHash   );
+        }
+        free( pChunks );
+        free( pKeys   );
+
+        printf( "%6d Total words\n"                   , nTotal          );
+        printf( "%6d words of %d different letters\n", nLetters, CHARS );
+        printf( "%6d unique %d letter words\n"        , gnWords , CHARS );
+    }
+
+    // ======================================================================
+    static inline Mask* Find( Mask *pKeys, int nSlots, int nShift, Mask nMask )
+    {
+        int iSlot = (int)(MaskHash( nMask ) >> nShift);
+
+        while (!IsEmpty( pKeys[ iSlot ] ) && (pKeys[ iSlot ] != nMask))
+            iSlot = (iSlot + 1) & (nSlots - 1);
+        return &pKeys[ iSlot ];
+    }
+
+    // Forward neighbors in compressed sparse row format, folded rows like ::Prepare()
+    // ======================================================================
+    static void Prepare()
+    {
+        gpStart = (int*) malloc( sizeof( int ) * (gnWords + 1) );
+        int *pAll = (int*) malloc( sizeof( int ) * (gnWords + 1) ); // 0 .. n-1
+        if (!gpStart || !pAll)
+            exit( printf( "ERROR: Couldn't allocate memory for %d words\n", gnWords ) );
+        for( int word = 0; word < gnWords; ++word )
+            pAll[ word ] = word;
+
+        ForFolds( gnWords, []( int, int word0 )
+        {
+            int nRow = 0;
+            for( int word1 = word0 + 1; word1 < gnWords; ++word1 )
+                nRow += IsEmpty( gpMasks[ word0 ] & gpMasks[ word1 ] );
+            gpStart[ word0+1 ] = nRow;
+        } );
+
+        gnMaxRow    = StartRows( gpStart, gnWords );
+        gpNeighbors = (int*) malloc( sizeof( int ) * ((size_t) gpStart[ gnWords ] + 1) );
+        int *pRows  = (int*) malloc( sizeof( int ) * (gnMaxRow + 16) * omp_get_max_threads() ); // per thread scratch row
+        if (!gpNeighbors || !pRows)
+            exit( printf( "ERROR: Couldn't allocate memory for %d neighbors\n", gpStart[ gnWords ] ) );
+
+        // Filter() may store past the end of the row, so fill a scratch row then copy it
+        ForFolds( gnWords, [pAll, pRows]( int iThread, int word0 )
+        {
+            int *pRow = pRows + (size_t) iThread * (gnMaxRow + 16);
+            int  nRow = Filter( pAll + word0 + 1, gnWords - word0 - 1, gpMasks[ word0 ], pRow );
+            memcpy( gpNeighbors + gpStart[ word0 ], pRow, nRow * sizeof( int ) );
+        } );
+
+        free( pRows );
+        free( pAll  );
+        printf( "%6d neighbors, max %d per word\n", gpStart[ gnWords ], gnMaxRow );
+    }
+
+    // Survivors of pIn that don't share any letters with nMask
+    // ======================================================================
+    static inline int Filter( const int *pIn, int nIn, Mask nMask, int *pOut )
+    {
+        return gpFilter( gpMasks, pIn, nIn, nMask, pOut );
+    }
+
+    // ======================================================================
+    static void Emit( int iThread, const int *pWords )
+    {
+        int iLetter = 0;
+        if (gbCount)
+        {
+            Mask nUsed = {};
+            for( int iWord = 0; iWord < WORDS; ++iWord )
+                nUsed = nUsed | gpMasks[ pWords[ iWord ] ];
+
+            while ((iLetter < gnAlphabet - 1) && !IsEmpty( nUsed & MaskBit< Mask >( iLetter ) ))
+                iLetter++;
+        }
+        WordEmit( &gaSinks[ iThread ], pWords, WORDS, iLetter );
+    }
+
+    // Every candidate is a forward neighbor of all the words chosen so far.  DEPTH is known at compile time
+    // so the recursion is unrolled into WORDS-1 nested loops, and the last level emits without filtering.
+    // ======================================================================
+    template< int DEPTH >
+    static inline void Search( int iThread, const int *pCand, int nCand, int *pWords, int *pLevels )
+    {
+        for( int iCand = 0; iCand < nCand; ++iCand )
+        {
+            pWords[ DEPTH ] = pCand[ iCand ];
+
+            if constexpr (DEPTH == WORDS-1)
+                Emit( iThread, pWords );
+            else
+            {
+                int *pNext = pLevels + (DEPTH-1) * (gnMaxRow + 16);
+                int  nNext = Filter( pCand + iCand + 1, nCand - iCand - 1, gpMasks[ pCand[ iCand ] ], pNext );
+                Search< DEPTH+1 >( iThread, pNext, nNext, pWords, pLevels );
+            }
+        }
+    }
+
+    // ======================================================================
+    static void SearchAll()
+    {
+#pragma omp parallel
+        {
+            int  iThread = omp_get_thread_num();
+            int  aWords[ WORDS ];
+            int *pLevels = (int*) malloc( sizeof( int ) * (gnMaxRow + 16) * (WORDS > 2 ? WORDS-2 : 1) ); // per level survivors
+
+            if (!pLevels)
+                exit( printf( "ERROR: Couldn't allocate memory for %d neighbors\n", gnMaxRow ) );
+
+#pragma omp for schedule(dynamic)
+            for( int word0 = 0; word0 < gnWords; ++word0 )
+            {
+                aWords[ 0 ] = word0;
+                if constexpr (WORDS == 1)
+                    Emit( iThread, aWords );
+                else
+                    Search< 1 >( iThread, gpNeighbors + gpStart[ word0 ], gpStart[ word0+1 ] - gpStart[ word0 ], aWords, pLevels );
+            }
+
+            free( pLevels );
+        }
+    }
+
+    // ======================================================================
+    static void PrintWord( int word )
+    {
+        printf( " %.*s,", gpBytes[ word ], gpWords[ word ] );
+    }
+
+    // ======================================================================
+    static void Run()
+    {
+        if (WORDS*CHARS > gnAlphabet)
+            exit( printf( "ERROR: %d words of %d letters need %d letters, alphabet has %d\n", WORDS, CHARS, WORDS*CHARS, gnAlphabet ) );
+
+#if USE_SIMD
+        if (gnSimd == SIMD_AVX2  ) gpFilter = FilterMaskAVX2;
+        if (gnSimd == SIMD_AVX512) gpFilter = FilterMaskAVX512;
+#endif
+
+        Parse();
         Prepare();
-        Search3();
-        Solutions();
+        SearchAll();
+        WordSolutions( gaSinks, WORDS, gnAlphabet - WORDS*CHARS, PrintWord );
+    }
+};
+
+// ======================================================================
+    struct Shape
+    {
+        const char *name;
+        void      (*Run32 )();                          // the narrowest mask that fits the alphabet is used
+        void      (*Run64 )();
+        void      (*Run128)();
+    };
+
+    const Shape gaShapes[] =
+    {
+        { "6x4", Puzzle< 6, 4, uint32_t >::Run, Puzzle< 6, 4, uint64_t >::Run, Puzzle< 6, 4, Mask128 >::Run },
+        { "5x5", Puzzle< 5, 5, uint32_t >::Run, Puzzle< 5, 5, uint64_t >::Run, Puzzle< 5, 5, Mask128 >::Run },
+        { "4x6", Puzzle< 4, 6, uint32_t >::Run, Puzzle< 4, 6, uint64_t >::Run, Puzzle< 4, 6, Mask128 >::Run },
+        { "3x8", Puzzle< 3, 8, uint32_t >::Run, Puzzle< 3, 8, uint64_t >::Run, Puzzle< 3, 8, Mask128 >::Run },
+    };
+    const int NUM_SHAPES = (int)(sizeof( gaShapes ) / sizeof( gaShapes[0] ));
+
+// ======================================================================
+const Shape* FindShape( const char *name )
+{
+    for( int iShape = 0; iShape < NUM_SHAPES; ++iShape )
+        if (strcmp( gaShapes[ iShape ].name, name ) == 0)
+            return &gaShapes[ iShape ];
+
+    printf( "ERROR: Unknown shape: %s\n", name );
+    return NULL;
+}
+
+// Exact cover of the letters by words of mixed lengths, e.g. -cover=4+5+5+5+6.  Letters the lengths can't reach may be skipped.
+// ======================================================================
+    struct CoverState                                   // per thread
+    {
+        int          iThread;
+        int          aLeft [ NUM_LETTERS+1 ];           // words of each length still to place
+        int          aWords[ NUM_LETTERS   ];           // chosen so far
+        int         *pLevels;                           // survivors of each level
+    };
+
+          int    gnCoverWords  = 0;                           // words per solution, 0 = -cover isn't used
+          int    gnCoverSkips  = 0;                           // letters no solution uses
+          int    gaCoverLengths[ NUM_LETTERS+1 ];             // words of each length per solution
+          int    gnCoverUnique = 0;
+    const char **gpCoverWords  = NULL;                        // first word of each mask, NOT null terminated
+          int   *gpCoverHash   = NULL;
+    unsigned char *gpCoverLength = NULL;
+          WordSink gaCoverSinks[ MAX_THREADS ];
+
+// Parses "4+5+5+5+6"
+// ======================================================================
+bool SetCover( const char *pText )
+{
+    memset( gaCoverLengths, 0, sizeof( gaCoverLengths ) );
+    gnCoverWords   = 0;
+    gnParseLengths = 0;
+
+    int nLetters = 0;
+    for(;;)
+    {
+        char *pNext;
+        int   nLength = (int) strtol( pText, &pNext, 10 );
+        if ((pNext == pText) || (nLength < 1) || (nLength > NUM_LETTERS) || ((nLetters += nLength) > NUM_LETTERS))
+            return false;
+
+        gaCoverLengths[ nLength ]++;
+        gnCoverWords++;
+        gnParseLengths |= 1 << nLength;
+
+        if (!*pNext)
+            break;
+        if (*pNext != '+')
+            return false;
+        pText = pNext + 1;
+    }
+
+    gnCoverSkips = NUM_LETTERS - nLetters;
+    return true;
+}
+
+// ======================================================================
+inline void CoverEmit( const CoverState *pState, int nSkipped )
+{
+    WordEmit( &gaCoverSinks[ pState->iThread ], pState->aWords, gnCoverWords, nSkipped ? __builtin_ctz( nSkipped ) : 0 );
+}
+
+// Candidates that don't share any letters with nHash and whose length is still needed
+// ======================================================================
+inline int CoverFilter( const CoverState *pState, const int *pIn, int nIn, int nHash, int *pOut )
+{
+    int nOut = 0;
+    for( int iIn = 0; iIn < nIn; ++iIn )
+    {
+        int word = pIn[ iIn ];
+        pOut[ nOut ] = word;
+        nOut += ((gpCoverHash[ word ] & nHash) == 0) & (pState->aLeft[ gpCoverLength[ word ] ] > 0); // branchless
+    }
+    return nOut;
+}
+
+// Picks the uncovered letter with the fewest candidates; returns -1 if the node can't lead to a solution
+// ======================================================================
+int CoverColumn( const CoverState *pState, const int *pCand, int nCand, int nUsed, int nSkips, int *pCount )
+{
+    int aCount      [ NUM_LETTERS   ] = { 0 };
+    int aLengthCount[ NUM_LETTERS+1 ] = { 0 };
+    for( int iCand = 0; iCand < nCand; ++iCand )
+    {
+        int word = pCand[ iCand ];
+        aLengthCount[ gpCoverLength[ word ] ]++;
+        for( int nHash = gpCoverHash[ word ]; nHash; nHash &= nHash - 1 )
+            aCount[ __builtin_ctz( nHash ) ]++;
+    }
+
+    // Each length still to place needs that many candidates
+    for( int nLength = 1; nLength <= NUM_LETTERS; ++nLength )
+        if (pState->aLeft[ nLength ] > aLengthCount[ nLength ])
+            return -1;
+
+    // Letters without candidates can only be skipped
+    int iBest  = -1;
+    int nBest  = nCand + 1;
+    int nEmpty = 0;
+    for( int nFree = ~nUsed & ALL_LETTERS; nFree; nFree &= nFree - 1 )
+    {
+        int iLetter = __builtin_ctz( nFree );
+        nEmpty += !aCount[ iLetter ];
+        if (nBest > aCount[ iLetter ])
+        {
+            nBest = aCount[ iLetter ];
+            iBest = iLetter;
+        }
+    }
+    if (nEmpty > nSkips)
+        return -1;
+
+    *pCount = nBest;
+    return iBest;
+}
+
+// Algorithm X on bitmasks: every uncovered letter is either covered by exactly one of its candidates, or skipped.
+// Branching on the letter with the fewest candidates keeps the tree narrow, and finds every solution exactly once.
+// ======================================================================
+void CoverFrom( CoverState *pState, const int *pCand, int nCand, int nUsed, int nSkips, int nSkipped, int nChosen, int nDepth )
+{
+    if (nUsed == ALL_LETTERS)
+    {
+        CoverEmit( pState, nSkipped );
+        return;
+    }
+
+    int nCount  = 0;
+    int iLetter = CoverColumn( pState, pCand, nCand, nUsed, nSkips, &nCount );
+    if (iLetter < 0)
+        return;
+
+    int  nLetter = 1 << iLetter;
+    int *pNext   = pState->pLevels + nDepth * gnCoverUnique;
+
+    for( int iCand = 0; nCount && (iCand < nCand); ++iCand )
+    {
+        int word = pCand[ iCand ];
+        if (!(gpCoverHash[ word ] & nLetter))
+            continue;
+
+        pState->aWords[ nChosen ] = word;
+        pState->aLeft[ gpCoverLength[ word ] ]--;
+
+        int nNext = CoverFilter( pState, pCand, nCand, gpCoverHash[ word ], pNext );
+        CoverFrom( pState, pNext, nNext, nUsed | gpCoverHash[ word ], nSkips, nSkipped, nChosen + 1, nDepth + 1 );
+
+        pState->aLeft[ gpCoverLength[ word ] ]++;
+    }
+
+    if (nSkips)
+    {
+        int nNext = CoverFilter( pState, pCand, nCand, nLetter, pNext );
+        CoverFrom( pState, pNext, nNext, nUsed | nLetter, nSkips - 1, nSkipped | nLetter, nChosen, nDepth + 1 );
+    }
+}
+
+// ======================================================================
+void CoverPrintWord( int word )
+{
+    printf( " %.*s,", gpCoverLength[ word ], gpCoverWords[ word ] );
+}
+
+// Parses the words of every length in the cover with the same chunks as Parse(), then searches
+// ======================================================================
+void Cover()
+{
+    int                nChunks = 0;
+    ParseChunk< int > *pChunks = ScanChunks< int, ParseLine >( &nChunks );
+
+    uint64_t *pSeen = (uint64_t*) calloc( (ALL_LETTERS + 1) / 64, sizeof( uint64_t ) ); // 8 MB, one bit per mask
+    if (!pSeen)
+        exit( printf( "ERROR: Couldn't allocate memory for %d masks\n", ALL_LETTERS + 1 ) );
+
+    int nTotalWords  = 0;
+    int nLengthWords = 0;
+    int nWords       = 0;
+    for( int iChunk = 0; iChunk < nChunks; ++iChunk )
+    {
+        nTotalWords  += pChunks[ iChunk ].nTotalWords;
+        nLengthWords += pChunks[ iChunk ].nLengthWords;
+        nWords       += pChunks[ iChunk ].nWords;
+    }
+
+    gpCoverWords  = (const char  **) malloc( sizeof( gpCoverWords [0] ) * (nWords + 1) );
+    gpCoverHash   = (int          *) malloc( sizeof( gpCoverHash  [0] ) * (nWords + 1) );
+    gpCoverLength = (unsigned char*) malloc( sizeof( gpCoverLength[0] ) * (nWords + 1) );
+    if (!gpCoverWords || !gpCoverHash || !gpCoverLength)
+        exit( printf( "ERROR: Couldn't allocate memory for %d words\n", nWords ) );
+
+    for( int iChunk = 0; iChunk < nChunks; ++iChunk )
+    {
+        ParseChunk< int > *pChunk = &pChunks[ iChunk ];
+        for( int iWord = 0; iWord < pChunk->nWords; ++iWord )
+        {
+            int nHash = pChunk->pHash[ iWord ];
+            if (pSeen[ nHash / 64 ] & (1ull << (nHash % 64))) // skip anagrams
+                continue;
+            pSeen[ nHash / 64 ] |= 1ull << (nHash % 64);
+
+            gpCoverWords [ gnCoverUnique ] = pChunk->ppWords[ iWord ];
+            gpCoverHash  [ gnCoverUnique ] = nHash;
+            gpCoverLength[ gnCoverUnique ] = (unsigned char) __builtin_popcount( nHash );
+            gnCoverUnique++;
+        }
+
+        free( pChunk->ppWords );
+        free( pChunk->pHash   );
+    }
+    free( pChunks );
+    free( pSeen   );
+
+    printf( "%6d Total words\n"              , nTotalWords   );
+    printf( "%6d words of the cover lengths\n", nLengthWords  );
+    printf( "%6d unique masks\n"              , gnCoverUnique );
+
+    // The root branches on its letter with the fewest candidates; each candidate, and skipping the letter, is a job
+    CoverState root;
+    memset( &root, 0, sizeof( root ) );
+    memcpy( root.aLeft, gaCoverLengths, sizeof( root.aLeft ) );
+
+    int *pCandidates = (int*) malloc( sizeof( int ) * (gnCoverUnique + 1) );
+    int *pRoot       = (int*) malloc( sizeof( int ) * (gnCoverUnique + 1) );
+    if (!pCandidates || !pRoot)
+        exit( printf( "ERROR: Couldn't allocate memory for %d words\n", gnCoverUnique ) );
+    for( int word = 0; word < gnCoverUnique; ++word )
+        pCandidates[ word ] = word;
+
+    int nCount  = 0;
+    int iLetter = CoverColumn( &root, pCandidates, gnCoverUnique, 0, gnCoverSkips, &nCount );
+    int nLetter = (iLetter < 0) ? 0 : (1 << iLetter);
+    int nRoot   = 0;
+    for( int word = 0; nLetter && (word < gnCoverUnique); ++word )
+        if (gpCoverHash[ word ] & nLetter)
+            pRoot[ nRoot++ ] = word;
+    int nJobs   = nLetter ? nRoot + (gnCoverSkips > 0) : 0;
+    printf( "%6d jobs\n", nJobs );
+
+#pragma omp parallel
+    {
+        CoverState state = root;
+        state.iThread = omp_get_thread_num();
+        state.pLevels = (int*) malloc( sizeof( int ) * gnCoverUnique * (gnCoverWords + gnCoverSkips + 1) );
+        if (!state.pLevels)
+            exit( printf( "ERROR: Couldn't allocate memory for %d words\n", gnCoverUnique ) );
+
+        int *pNext = state.pLevels;
+
+#pragma omp for schedule(dynamic)
+        for( int iJob = 0; iJob < nJobs; ++iJob )
+        {
+            if (iJob < nRoot) // cover the letter with this word
+            {
+                int word = pRoot[ iJob ];
+                state.aWords[ 0 ] = word;
+                state.aLeft[ gpCoverLength[ word ] ]--;
+
+                int nNext = CoverFilter( &state, pCandidates, gnCoverUnique, gpCoverHash[ word ], pNext );
+                CoverFrom( &state, pNext, nNext, gpCoverHash[ word ], gnCoverSkips, 0, 1, 1 );
+
+                state.aLeft[ gpCoverLength[ word ] ]++;
+            }
+            else // or skip it
+            {
+                int nNext = CoverFilter( &state, pCandidates, gnCoverUnique, nLetter, pNext );
+                CoverFrom( &state, pNext, nNext, nLetter, gnCoverSkips - 1, nLetter, 0, 1 );
+            }
+        }
+
+        free( state.pLevels );
+    }
+
+    free( pRoot       );
+    free( pCandidates );
+    WordSolutions( gaCoverSinks, gnCoverWords, gnCoverSkips, CoverPrintWord );
+}
+
+// ======================================================================
+    struct Engine
+    {
+        const char *name;
+        void      (*Prepare)();
+        void      (*Search )();
+        bool        bGraph;     // searches the DAG built by Prepare()
+        const char *description;
+    };
+
+    const Engine gaEngines[] =
+    {
+        { "dag"   , Prepare      , Search3     , true , "5 nested loops over the DAG of forward neighbors"   },
+        { "pairs" , Prepare      , SearchPairs , true , "dag, dynamically scheduled per (word0, word1) pair" },
+        { "filter", PrepareFilter, SearchFilter, true , "each level filters the previous level's candidates" },
+        { "join"  , PrepareJoin  , SearchJoin  , true , "3-word cliques joined with a hash index of pairs"   },
+        { "bitset", PrepareBitset, SearchBitset, false, "intersect bitsets of compatible words per level"    },
+        { "rare"  , PrepareRare  , SearchRare  , false, "branch on the rarest uncovered letter"              },
+        { "zeta"  , PrepareZeta  , SearchZeta  , false, "count only, subset convolution over letter masks"   },
+        { "memo"  , PrepareMemo  , SearchMemo  , true , "dag, completions memoized by the letters of 3 words" },
+        { "split" , PrepareSplit , SearchSplit , false, "one job per missing letter, output grouped by it"    },
+    };
+    const int NUM_ENGINES = (int)(sizeof( gaEngines ) / sizeof( gaEngines[0] ));
+
+// ======================================================================
+const Engine* FindEngine( const char *name )
+{
+    for( int iEngine = 0; iEngine < NUM_ENGINES; ++iEngine )
+        if (strcmp( gaEngines[ iEngine ].name, name ) == 0)
+            return &gaEngines[ iEngine ];
+
+    printf( "ERROR: Unknown engine: %s\n", name );
+    return NULL;
+}
+
+// ======================================================================
+    struct Order
+    {
+        const char *name;
+        void      (*Order)();
+        const char *description;
+    };
+
+    const Order gaOrders[] =
+    {
+        { "file"      , NULL           , "dictionary order"                        },
+        { "degree"    , OrderDegree    , "fewest compatible words first"           },
+        { "degeneracy", OrderDegeneracy, "bounds forward neighbors by degeneracy"  },
+        { "mask"      , OrderMask      , "sorted by letter mask"                   },
+        { "rcm"       , OrderRcm       , "reverse Cuthill-McKee, lowers bandwidth" },
+    };
+    const int NUM_ORDERS = (int)(sizeof( gaOrders ) / sizeof( gaOrders[0] ));
+
+// ======================================================================
+const Order* FindOrder( const char *name )
+{
+    for( int iOrder = 0; iOrder < NUM_ORDERS; ++iOrder )
+        if (strcmp( gaOrders[ iOrder ].name, name ) == 0)
+            return &gaOrders[ iOrder ];
+
+    printf( "ERROR: Unknown order: %s\n", name );
+    return NULL;
+}
+
+// ======================================================================
+int FindSimd( const char *name )
+{
+    for( int iSimd = 0; iSimd < NUM_SIMD; ++iSimd )
+        if (strcmp( gaSimdNames[ iSimd ], name ) == 0)
+            return iSimd;
+
+    printf( "ERROR: Unknown SIMD level: %s\n", name );
+    return -1;
+}
+
+// ======================================================================
+void Usage()
+{
+    printf( "Usage: 5letters5words [threads] [dictionary] [-engine=name] [-simd=scalar|avx2|avx512] [-prune] [-order=name] [-count] [-anagrams] [-cache[=file]] [-shape=WxC] [-alphabet=letters|@file] [-cover=lengths]\n" );
+    printf( "Engines:\n" );
+    for( int iEngine = 0; iEngine < NUM_ENGINES; ++iEngine )
+        printf( "    %-10s %s\n", gaEngines[ iEngine ].name, gaEngines[ iEngine ].description );
+    printf( "Orders:\n" );
+    for( int iOrder = 0; iOrder < NUM_ORDERS; ++iOrder )
+        printf( "    %-10s %s\n", gaOrders[ iOrder ].name, gaOrders[ iOrder ].description );
+    printf( "Shapes:\n   " );
+    for( int iShape = 0; iShape < NUM_SHAPES; ++iShape )
+        printf( " %s", gaShapes[ iShape ].name );
+    printf( "\n" );
+}
+
+// ======================================================================
+int main( int nArg, char *aArg[] )
+{
+    auto begin = std::chrono::high_resolution_clock::now();
+
+        int           gnCurThreads = 0; // auto-detect, use max threads
+        const char   *pFilename    = "words_alpha.txt"; // NOTE: words_alpha.txt (in MS-DOS format) has varying lengths of non-unique words
+        const Engine *pEngine      = &gaEngines[ 0 ];
+        const Order  *pOrder       = &gaOrders [ 0 ];
+        const Shape  *pShape       = NULL;      // NULL is the 5x5 engines
+        const char   *pAlphabet    = "abcdefghijklmnopqrstuvwxyz";
+        int           nPositional  = 0;
+
+        for( int iArg = 1; iArg < nArg; ++iArg )
+        {
+            const char *pArg = aArg[ iArg ];
+            if ((pArg[0] == '-') && pArg[1]) // "-" alone is stdin
+            {
+                if (strncmp( pArg, "-engine=", 8 ) == 0)
+                {
+                    pEngine = FindEngine( pArg + 8 );
+                    if (!pEngine)
+                        return Usage(), 1;
+                }
+                else if (strncmp( pArg, "-simd=", 6 ) == 0)
+                {
+                    gnSimd = FindSimd( pArg + 6 );
+                    if (gnSimd < 0)
+                        return Usage(), 1;
+                }
+                else if (strncmp( pArg, "-order=", 7 ) == 0)
+                {
+                    pOrder = FindOrder( pArg + 7 );
+                    if (!pOrder)
+                        return Usage(), 1;
+                }
+                else if (strcmp( pArg, "-prune" ) == 0)
+                    gbPrune = true;
+                else if (strcmp( pArg, "-count" ) == 0)
+                    gbCount = true;
+                else if (strcmp( pArg, "-anagrams" ) == 0)
+                    gbAnagrams = true;
+                else if (strncmp( pArg, "-shape=", 7 ) == 0)
+                {
+                    pShape = FindShape( pArg + 7 );
+                    if (!pShape)
+                        return Usage(), 1;
+                }
+                else if (strncmp( pArg, "-alphabet=", 10 ) == 0)
+                {
+                    pAlphabet = pArg + 10;
+                    if (!pShape)
+                        pShape = FindShape( "5x5" );
+                }
+                else if (strncmp( pArg, "-cover=", 7 ) == 0)
+                {
+                    if (!SetCover( pArg + 7 ))
+                        return printf( "ERROR: Invalid word lengths: %s\n", pArg + 7 ), Usage(), 1;
+                }
+                else if (strncmp( pArg, "-cache=", 7 ) == 0)
+                    gpCacheName = pArg + 7;
+                else if (strcmp( pArg, "-cache" ) == 0)
+                    gpCacheName = "";
+                else
+                    return Usage(), (strcmp( pArg, "-help" ) != 0);
+            }
+            else if (nPositional++ == 0)
+                gnCurThreads = atoi( pArg );
+            else
+                pFilename = pArg;
+        }
+
+        // Only the 5x5 engines keep the anagrams, and -cover is always a-z
+        if ((pShape || gnCoverWords) && gbAnagrams)
+            return printf( "ERROR: -anagrams can't be combined with -%s\n", pShape ? "shape or -alphabet" : "cover" ), Usage(), 1;
+        if (pShape && gnCoverWords)
+            return printf( "ERROR: -cover can't be combined with -shape or -alphabet\n" ), Usage(), 1;
+
+        static char aCacheName[ 1024 ];
+        if (gpCacheName && !*gpCacheName) // default is next to the dictionary
+        {
+            snprintf( aCacheName, sizeof( aCacheName ), "%s.cache", (strcmp( pFilename, "-" ) == 0) ? "stdin" : pFilename );
+            gpCacheName = aCacheName;
+        }
+
+        int gnMaxThreads = omp_get_max_threads(); // omp_get_num_procs();
+        omp_set_num_threads( gnCurThreads );
+        gnCurThreads = gnCurThreads ? gnCurThreads : gnMaxThreads;
+        printf( "Using %d / %d threads\n", gnCurThreads, gnMaxThreads );
+
+        Init();
+        Read4( pFilename );
+        SetAlphabet( (*pAlphabet == '@') ? ReadAlphabet( pAlphabet + 1 ) : pAlphabet );
+        if (pShape)
+        {
+            if      (gnAlphabet <= 32) pShape->Run32 ();
+            else if (gnAlphabet <= 64) pShape->Run64 ();
+            else                       pShape->Run128();
+        }
+        else if (gnCoverWords)
+            Cover();
+        else
+        {
+            // Only worth building the graph if pruning or the search will read it in file order
+            bool bGraph  = gbPrune || (pEngine->bGraph && !pOrder->Order);
+            bool bLoaded = gpCacheName && LoadCache( bGraph );
+            if (!bLoaded && !Parse())
+            {
+                // Word ids of these engines are short, but Puzzle<> has no limit on the number of words
+                if (gbAnagrams)
+                    return printf( "ERROR: More than %d unique %d letter words, -anagrams needs fewer\n", MAX_5_WORDS, NUM_CHARS ), 1;
+                printf( "More than %d unique %d letter words, searching them as -shape=5x5\n", MAX_5_WORDS, NUM_CHARS );
+                FindShape( "5x5" )->Run32();
+            }
+            else
+            {
+                if (!bLoaded && gpCacheName)
+                    SaveCache( bGraph );
+                if (gbPrune)
+                    Prune();
+                if (pOrder->Order)
+                    pOrder->Order();
+                pEngine->Prepare();
+                pEngine->Search();
+                Solutions();
+            }
+        }
 
     auto end    = std::chrono::high_resolution_clock::now();
     int ms      = (int) std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();